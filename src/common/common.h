@@ -46,5 +46,6 @@
 #include "./messages/BroadcastLeaderFragment_m.h"
 #include "./messages/BroadcastCTS_m.h"
 #include "./messages/BroadcastFragment_m.h"
+#include "./messages/LoRaFrameCast.h"
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef COMMON_MESSAGES_LORAFRAMECAST_H_
+#define COMMON_MESSAGES_LORAFRAMECAST_H_
+
+#include "LoRaFrameBase_m.h"
+#include "NodeAnnounce_m.h"
+#include "BroadcastRts_m.h"
+#include "BroadcastContinuousRts_m.h"
+#include "BroadcastLeaderFragment_m.h"
+#include "BroadcastCTS_m.h"
+#include "BroadcastFragment_m.h"
+
+namespace rlora
+{
+    template <typename T>
+    struct LoRaFrameTypeOf;
+
+    template <> struct LoRaFrameTypeOf<BroadcastRts> { static constexpr LoRaFrameType value = LORA_FRAME_BROADCAST_RTS; };
+    template <> struct LoRaFrameTypeOf<BroadcastContinuousRts> { static constexpr LoRaFrameType value = LORA_FRAME_BROADCAST_CONTINUOUS_RTS; };
+    template <> struct LoRaFrameTypeOf<BroadcastCTS> { static constexpr LoRaFrameType value = LORA_FRAME_BROADCAST_CTS; };
+    template <> struct LoRaFrameTypeOf<BroadcastLeaderFragment> { static constexpr LoRaFrameType value = LORA_FRAME_BROADCAST_LEADER_FRAGMENT; };
+    template <> struct LoRaFrameTypeOf<BroadcastFragment> { static constexpr LoRaFrameType value = LORA_FRAME_BROADCAST_FRAGMENT; };
+    template <> struct LoRaFrameTypeOf<NodeAnnounce> { static constexpr LoRaFrameType value = LORA_FRAME_NODE_ANNOUNCE; };
+
+    // The one RTTI check per received frame, nullptr if the chunk isn't a LoRa frame.
+    inline const LoRaFrameBase *asLoRaFrame(const inet::Chunk *chunk)
+    {
+        return dynamic_cast<const LoRaFrameBase *>(chunk);
+    }
+
+    // Replaces dynamic_cast<const T *> on the result of asLoRaFrame with a type compare.
+    template <typename T>
+    inline const T *loRaFrameCast(const LoRaFrameBase *frame)
+    {
+        return frame != nullptr && frame->getFrameType() == LoRaFrameTypeOf<T>::value ? static_cast<const T *>(frame) : nullptr;
+    }
+}
+
+#endif
@@ -3,12 +3,23 @@
 namespace rlora {
 
 CustomPacketQueue::~CustomPacketQueue()
+{
+    clear();
+}
+
+void CustomPacketQueue::setFragmentMaterializer(FragmentMaterializer materializer)
+{
+    fragmentMaterializer = std::move(materializer);
+}
+
+void CustomPacketQueue::clear()
 {
     while (!packetQueue.empty()) {
-        delete packetQueue.front();
+        delete packetQueue.front().packet;
 
         packetQueue.pop_front();
     }
+    hasNeighbourGroup = false;
 }
 
 string CustomPacketQueue::toString() const
@@ -17,105 +28,117 @@ string CustomPacketQueue::toString() const
     EV << "CustomPacketQueue [size=" << packetQueue.size() << "]" << endl;
 
     int index = 0;
-    for (auto pkt : packetQueue) {
-        EV << "  [" << index++ << "] " << pkt << endl;
+    for (auto& entry : packetQueue) {
+        if (entry.packet != nullptr)
+            EV << "  [" << index++ << "] " << entry.packet << endl;
+        else
+            EV << "  [" << index++ << "] fragment " << entry.fragment.fragmentId << " of " << entry.fragment.messageId << endl;
     }
 
     return oss.str();
 }
 
+void CustomPacketQueue::rebuildNeighbourGroup()
+{
+    hasNeighbourGroup = false;
+    for (auto it = packetQueue.begin(); it != packetQueue.end(); ++it) {
+        if (!it->isNeighbourMsg)
+            continue;
+        if (!hasNeighbourGroup && it->isHeader) {
+            hasNeighbourGroup = true;
+            neighbourGroupHeader = it;
+        }
+        if (hasNeighbourGroup)
+            neighbourGroupLast = it;
+    }
+}
+
 void CustomPacketQueue::enqueuePacket(Packet *pkt)
 {
     auto typeTag = pkt->getTag<MessageInfoTag>();
+    enqueueEntry(QueueEntry{pkt, typeTag->isNeighbourMsg(), typeTag->isHeader(), FragmentDescriptor()});
+}
+
+void CustomPacketQueue::enqueueFragment(const FragmentDescriptor &fragment)
+{
+    enqueueEntry(QueueEntry{nullptr, fragment.isNeighbourMsg, false, fragment});
+}
+
+void CustomPacketQueue::enqueueEntry(const QueueEntry &entry)
+{
     EV << "CustomPacketQueue::enqueuePacket" << endl;
 
-    if (!typeTag->isNeighbourMsg()) {
+    if (!entry.isNeighbourMsg) {
         EV << "This is Mission - Just adding to back" << endl;
-        packetQueue.push_back(pkt);
+        packetQueue.push_back(entry);
         return;
     }
 
-    if (typeTag->isHeader()) {
-        // Remove all NeighbourMsg packets and find the position of the first one
-        int firstNeighbourPos = -1;
-        int index = 0;
-
-        for (auto it = packetQueue.begin(); it != packetQueue.end();) {
-            auto tag = (*it)->getTag<MessageInfoTag>();
-
-            // if the header was already sent we dont want to override the rest of the packet
-            if (tag->isNeighbourMsg() && firstNeighbourPos == -1 && !tag->isHeader()) {
-                EV << "Header already sent, we dont want to override rest - just need to append to back" << endl;
-                ++it;
-                ++index;
-                continue;
-            }
+    if (entry.isHeader) {
+        // neighbour fragments in front of the pending header belong to a message whose
+        // header was already sent, they stay. The pending message is replaced in place.
+        if (!hasNeighbourGroup) {
+            EV << "No neighbour MSG - adding to back" << endl;
+            packetQueue.push_back(entry);
+            hasNeighbourGroup = true;
+            neighbourGroupHeader = neighbourGroupLast = prev(packetQueue.end());
+            return;
+        }
 
-            if (tag->isNeighbourMsg()) {
-                if (firstNeighbourPos == -1) {
-                    firstNeighbourPos = index;
-                }
-                delete *it;
-                it = packetQueue.erase(it); // erase returns the next valid iterator
+        auto it = neighbourGroupHeader;
+        auto end = next(neighbourGroupLast);
+        neighbourGroupHeader = neighbourGroupLast = packetQueue.insert(it, entry);
+        while (it != end) {
+            if (it->isNeighbourMsg) {
+                delete it->packet;
+                it = packetQueue.erase(it);
                 EV << "Erase neighbour packet" << endl;
             }
-            else {
-                EV << "Just go to Next" << endl;
+            else
                 ++it;
-                ++index;
-            }
-        }
-
-        // If no NeighbourMsgs were found, just push_back
-        if (firstNeighbourPos == -1) {
-            EV << "No neighbour MSG - adding to back" << endl;
-            packetQueue.push_back(pkt);
-        }
-        else {
-            EV << "removed all unwanted and now enqueuing at postion" << endl;
-            enqueuePacketAtPosition(pkt, firstNeighbourPos);
         }
     }
     else {
         // Insert pkt after the last NeighbourMsg
-        auto it = packetQueue.begin();
-        auto lastNeighbourIt = packetQueue.end();
-
-        bool allowedToinsert = false;
-
-        for (; it != packetQueue.end(); ++it) {
-            auto tag = (*it)->getTag<MessageInfoTag>();
-
-            if (tag->isNeighbourMsg() && tag->isHeader()) {
-                allowedToinsert = true;
-            }
-
-            if (tag->isNeighbourMsg() && allowedToinsert) {
-                lastNeighbourIt = it;
-            }
-        }
-
-        if (lastNeighbourIt != packetQueue.end()) {
-            ++lastNeighbourIt; // move after the last NeighbourMsg
-            packetQueue.insert(lastNeighbourIt, pkt);
-        }
-        else {
-            packetQueue.push_front(pkt); // no NeighbourMsgs, put at the beginning
-        }
+        if (hasNeighbourGroup)
+            neighbourGroupLast = packetQueue.insert(next(neighbourGroupLast), entry);
+        else
+            packetQueue.push_front(entry); // no NeighbourMsgs, put at the beginning
     }
 }
 
 void CustomPacketQueue::enqueuePacketAtPosition(Packet *pkt, int pos)
 {
+    auto typeTag = pkt->getTag<MessageInfoTag>();
     auto it = packetQueue.begin();
     advance(it, pos);
-    packetQueue.insert(it, pkt);
+    packetQueue.insert(it, QueueEntry{pkt, typeTag->isNeighbourMsg(), typeTag->isHeader(), FragmentDescriptor()});
+    // anything but a header put at the front leaves the pending neighbour message as it is
+    if (pos != 0 || (typeTag->isNeighbourMsg() && typeTag->isHeader()))
+        rebuildNeighbourGroup();
 }
 
 Packet* CustomPacketQueue::dequeuePacket()
 {
     if (!packetQueue.empty()) {
-        auto pkt = packetQueue.front();
+        auto front = packetQueue.begin();
+        auto pkt = front->packet;
+        if (hasNeighbourGroup && front == neighbourGroupHeader) {
+            // the rest of the message can no longer be replaced, the next header behind it takes over
+            hasNeighbourGroup = false;
+            for (auto it = next(front); it != next(neighbourGroupLast); ++it) {
+                if (it->isNeighbourMsg && it->isHeader) {
+                    hasNeighbourGroup = true;
+                    neighbourGroupHeader = it;
+                    break;
+                }
+            }
+        }
+        if (pkt == nullptr) {
+            if (!fragmentMaterializer)
+                throw cRuntimeError("No fragment materializer set for the queued fragment descriptors");
+            pkt = fragmentMaterializer(front->fragment);
+        }
         packetQueue.pop_front();
         return pkt;
     }
@@ -131,13 +154,17 @@ void CustomPacketQueue::removePacketAtPosition(int pos)
     auto it = packetQueue.begin();
     advance(it, pos);
 
-    delete *it;
+    delete it->packet;
     packetQueue.erase(it);
+    rebuildNeighbourGroup();
 }
 
 void CustomPacketQueue::removePacket(Packet *pkt)
 {
-    packetQueue.remove(pkt);
+    if (pkt == nullptr)
+        return;
+    packetQueue.remove_if([pkt] (const QueueEntry& entry) { return entry.packet == pkt; });
+    rebuildNeighbourGroup();
     delete pkt;
 }
 
@@ -2,6 +2,7 @@
 #define HELPERS_CUSTOMPACKETQUEUE_H_
 
 #include <list>
+#include <functional>
 #include "inet/common/packet/Packet.h"
 #include "../common/tags/MessageInfoTag_m.h"
 
@@ -10,17 +11,61 @@ using namespace inet;
 namespace rlora
 {
 
+    // Everything needed to build a BroadcastFragment packet when it is dequeued.
+    // The wait time is drawn when the message is created, -1 means no WaitTimeTag.
+    struct FragmentDescriptor
+    {
+        int messageId = -1;
+        int missionId = -1;
+        int source = -1;
+        int fragmentId = 0;
+        int payloadSize = 0;
+        int waitTime = -1;
+        bool isNeighbourMsg = false;
+        bool isContinuous = false; // part of a message sent with continuous RTS
+        bool hasRegularHeader = true;
+    };
+
     class CustomPacketQueue
     {
+    public:
+        using FragmentMaterializer = std::function<Packet *(const FragmentDescriptor &fragment)>;
+
     private:
-        list<Packet *> packetQueue;
+        // the message type is cached, so the queue never looks at the tags again.
+        // Fragments are queued as descriptors, packet is nullptr until they are dequeued.
+        struct QueueEntry
+        {
+            Packet *packet;
+            bool isNeighbourMsg;
+            bool isHeader;
+            FragmentDescriptor fragment;
+        };
+
+        list<QueueEntry> packetQueue;
+
+        // The pending neighbour message: its header is the first neighbour header in
+        // the queue and last is the last neighbour packet behind it. Packets of the
+        // message are appended after last, a new header replaces the whole range.
+        bool hasNeighbourGroup = false;
+        list<QueueEntry>::iterator neighbourGroupHeader;
+        list<QueueEntry>::iterator neighbourGroupLast;
+
+        FragmentMaterializer fragmentMaterializer;
+
+        void rebuildNeighbourGroup();
+        void enqueueEntry(const QueueEntry &entry);
 
     public:
         virtual ~CustomPacketQueue();
 
+        void setFragmentMaterializer(FragmentMaterializer materializer);
         void enqueuePacket(Packet *pkt);
+        void enqueueFragment(const FragmentDescriptor &fragment);
         void enqueuePacketAtPosition(Packet *pkt, int pos);
         Packet *dequeuePacket();
+        // deletes the queued packets without building the pending fragments
+        void clear();
         void removePacketAtPosition(int pos);
         void removePacket(Packet *entry);
         bool isEmpty() const;
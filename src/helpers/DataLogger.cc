@@ -1,7 +1,7 @@
 #include "DataLogger.h"
 #include <fstream>
-#include <sstream>
-#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
 namespace rlora
 {
@@ -44,13 +44,7 @@ namespace rlora
 
     void DataLogger::logCollision(int id1, int id2)
     {
-        int minId = min(id1, id2);
-        int maxId = max(id1, id2);
-
-        ostringstream oss;
-        oss << minId << "," << maxId;
-
-        collisionSet.insert(oss.str());
+        collisionSet.insert(id1, id2);
     }
 
     void DataLogger::logEffectiveBytesReceived(int size)
@@ -102,13 +96,7 @@ namespace rlora
 
     void DataLogger::logPossibleCollision(int id1, int id2)
     {
-        int minId = min(id1, id2);
-        int maxId = max(id1, id2);
-
-        ostringstream oss;
-        oss << minId << "," << maxId;
-
-        possibleCollisionSet.insert(oss.str());
+        possibleCollisionSet.insert(id1, id2);
     }
 
     void DataLogger::writeDataToFile(const string &filename)
@@ -141,4 +129,27 @@ namespace rlora
         out.close();
         clear();
     }
+
+    void DataLogger::writeCollisionPairsToFile(const string &filename)
+    {
+        ofstream out(filename);
+        if (!out.is_open())
+        {
+            throw runtime_error("Fehler beim Öffnen der Datei " + filename);
+        }
+
+        vector<pair<int, int>> pairs;
+        out << "Collisions\n";
+        collisionSet.exportPairs(pairs);
+        for (const auto &p : pairs)
+            out << p.first << "," << p.second << "\n";
+
+        pairs.clear();
+        out << "Possible Collisions\n";
+        possibleCollisionSet.exportPairs(pairs);
+        for (const auto &p : pairs)
+            out << p.first << "," << p.second << "\n";
+
+        out.close();
+    }
 }
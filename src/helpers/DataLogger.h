@@ -2,7 +2,8 @@
 #define HELPERS_DATALOGGER_H_
 
 #include <string>
-#include <set>
+
+#include "IdPairSet.h"
 
 namespace rlora
 {
@@ -14,8 +15,8 @@ namespace rlora
     private:
         static DataLogger *instance;
 
-        set<string> collisionSet;
-        set<string> possibleCollisionSet;
+        IdPairSet collisionSet;
+        IdPairSet possibleCollisionSet;
 
         int transmissions = 0;
         int effectiveTransmissions = 0;
@@ -62,6 +63,8 @@ namespace rlora
         void logBytesReceivedIncludingCollisions(int size);          // ✅
 
         void writeDataToFile(const std::string &filename = "data.txt");
+        // one "id1,id2" line per pair, collisions first, then the possible collisions
+        void writeCollisionPairsToFile(const std::string &filename);
     };
 
 }
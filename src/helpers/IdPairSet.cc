@@ -0,0 +1,100 @@
+#include "IdPairSet.h"
+#include <algorithm>
+
+namespace rlora
+{
+
+    const uint64_t IdPairSet::EMPTY_KEY;
+
+    IdPairSet::IdPairSet() : slots(1024, EMPTY_KEY)
+    {
+    }
+
+    uint64_t IdPairSet::makeKey(int id1, int id2)
+    {
+        uint32_t minId = (uint32_t)min(id1, id2);
+        uint32_t maxId = (uint32_t)max(id1, id2);
+        return ((uint64_t)minId << 32) | maxId;
+    }
+
+    size_t IdPairSet::hash(uint64_t key)
+    {
+        // 64 bit finalizer of MurmurHash3, spreads consecutive ids over the table
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return (size_t)key;
+    }
+
+    bool IdPairSet::insert(int id1, int id2)
+    {
+        // keep the load factor below 1/2
+        if (2 * (count + 1) > slots.size())
+            rehash(2 * slots.size());
+
+        uint64_t key = makeKey(id1, id2);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == key)
+                return false;
+            if (slots[i] == EMPTY_KEY)
+            {
+                slots[i] = key;
+                count++;
+                return true;
+            }
+        }
+    }
+
+    bool IdPairSet::contains(int id1, int id2) const
+    {
+        uint64_t key = makeKey(id1, id2);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == key)
+                return true;
+            if (slots[i] == EMPTY_KEY)
+                return false;
+        }
+    }
+
+    void IdPairSet::rehash(size_t newCapacity)
+    {
+        vector<uint64_t> oldSlots(newCapacity, EMPTY_KEY);
+        oldSlots.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (uint64_t key : oldSlots)
+        {
+            if (key == EMPTY_KEY)
+                continue;
+            size_t i = hash(key) & mask;
+            while (slots[i] != EMPTY_KEY)
+                i = (i + 1) & mask;
+            slots[i] = key;
+        }
+    }
+
+    void IdPairSet::clear()
+    {
+        vector<uint64_t>(1024, EMPTY_KEY).swap(slots);
+        count = 0;
+    }
+
+    void IdPairSet::exportPairs(vector<pair<int, int>> &pairs) const
+    {
+        vector<uint64_t> keys;
+        keys.reserve(count);
+        for (uint64_t key : slots)
+            if (key != EMPTY_KEY)
+                keys.push_back(key);
+        sort(keys.begin(), keys.end());
+        pairs.reserve(pairs.size() + keys.size());
+        for (uint64_t key : keys)
+            pairs.push_back(make_pair((int)(key >> 32), (int)(key & 0xffffffffULL)));
+    }
+
+}
@@ -0,0 +1,45 @@
+#ifndef HELPERS_IDPAIRSET_H_
+#define HELPERS_IDPAIRSET_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rlora
+{
+
+    using namespace std;
+
+    /**
+     * Set of unordered id pairs. Every pair is packed into one 64 bit key (min id in the
+     * upper, max id in the lower half) and stored in an open addressing hash table with
+     * linear probing, so inserting does not allocate per pair. Ids must be non-negative.
+     */
+    class IdPairSet
+    {
+    private:
+        static const uint64_t EMPTY_KEY = UINT64_MAX;
+
+        vector<uint64_t> slots;
+        size_t count = 0;
+
+        static uint64_t makeKey(int id1, int id2);
+        static size_t hash(uint64_t key);
+        void rehash(size_t newCapacity);
+
+    public:
+        IdPairSet();
+
+        /** Returns true if the pair was not yet in the set. */
+        bool insert(int id1, int id2);
+        bool contains(int id1, int id2) const;
+        size_t size() const { return count; }
+        void clear();
+
+        /** Appends all pairs as (min id, max id) sorted ascending. */
+        void exportPairs(vector<pair<int, int>> &pairs) const;
+    };
+
+}
+
+#endif
@@ -18,41 +18,43 @@ namespace rlora
 
     FragmentedPacket *IncompletePacketList::getPacketById(int id)
     {
-        for (FragmentedPacket &packet : packets_)
-        {
-            if (packet.messageId == id && !isMissionList_)
-            {
-                return &packet;
-            }
-
-            if (packet.missionId == id && isMissionList_)
-            {
-                return &packet;
-            }
-        }
-        return nullptr;
+        auto it = packets_.find(id);
+        return it != packets_.end() ? &it->second : nullptr;
     }
 
     void IncompletePacketList::removePacketById(int id)
     {
-        packets_.erase(std::remove_if(packets_.begin(), packets_.end(), [id](const FragmentedPacket &packet)
-                                      { return packet.messageId == id; }),
-                       packets_.end());
+        // matches on the messageId in both lists, in the mission list only the packet
+        // keyed by the same missionId can have it
+        auto it = packets_.find(id);
+        if (it == packets_.end() || it->second.messageId != id)
+            return;
+        keysBySource_.erase(it->second.sourceNode);
+        packets_.erase(it);
     }
 
     void IncompletePacketList::addPacket(const FragmentedPacket &packet)
     {
         removePacketBySource(packet.sourceNode);
-        packets_.push_back(packet);
+        int key = getKey(packet);
+        auto it = packets_.find(key);
+        if (it != packets_.end())
+        {
+            keysBySource_.erase(it->second.sourceNode);
+            it->second = packet;
+        }
+        else
+            packets_.emplace(key, packet);
+        keysBySource_[packet.sourceNode] = key;
     }
 
     void IncompletePacketList::removePacketBySource(int source)
     {
-        auto it = std::remove_if(packets_.begin(), packets_.end(), [source](const FragmentedPacket &packet)
-                                 { return packet.sourceNode == source; });
-        if (it != packets_.end())
+        auto it = keysBySource_.find(source);
+        if (it != keysBySource_.end())
         {
-            packets_.erase(it, packets_.end());
+            packets_.erase(it->second);
+            keysBySource_.erase(it);
         }
     }
 
@@ -101,7 +103,7 @@ namespace rlora
                 result.sendUp = true;
                 result.waitTime = waitTime;
                 result.isMission = incompletePacket->isMission;
-                result.completePacket = *incompletePacket;
+                result.completePacket = incompletePacket;
                 return result;
             }
             else
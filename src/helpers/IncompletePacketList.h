@@ -2,6 +2,7 @@
 #define HELPERS_INCOMPLETEPACKETLIST_H_
 
 #include <vector>
+#include <bitset>
 #include <cstdint>
 #include <sstream>
 #include <cstring>
@@ -25,7 +26,7 @@ namespace rlora
         int missionId = -1;
         int size = -1;
         int received = 0;
-        bool fragments[256] = {false};
+        bitset<256> fragments;
         int sourceNode = -1;
         int lastHop = -1;
         bool corrupted = false;
@@ -39,7 +40,8 @@ namespace rlora
         bool isMission = false;
         bool isRelevant = true;
         int waitTime;
-        FragmentedPacket completePacket = FragmentedPacket();
+        // points into the list, valid until the packet is removed or replaced
+        const FragmentedPacket *completePacket = nullptr;
     };
 
     class IncompletePacketList
@@ -64,7 +66,12 @@ namespace rlora
         void setLogFragmentCallback(LogFunc func);
 
     private:
-        std::vector<FragmentedPacket> packets_;
+        int getKey(const FragmentedPacket &packet) const { return isMissionList_ ? packet.missionId : packet.messageId; }
+
+        // keyed by missionId in the mission list and by messageId otherwise
+        std::unordered_map<int, FragmentedPacket> packets_;
+        // there is at most one packet per source, this maps the source to its key
+        std::unordered_map<int, int> keysBySource_;
         std::unordered_map<int, int> latestIds_;
         bool isMissionList_;
 
@@ -0,0 +1,111 @@
+#include "WorkerPool.h"
+
+namespace rlora
+{
+
+    WorkerPool::WorkerPool(int numThreads) : nextIndex(0)
+    {
+        for (int i = 0; i < numThreads; i++)
+            threads.emplace_back(&WorkerPool::run, this);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            unique_lock<mutex> guard(lock);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (auto &t : threads)
+            t.join();
+    }
+
+    void WorkerPool::run()
+    {
+        uint64_t seenGeneration = 0;
+        while (true)
+        {
+            unique_lock<mutex> guard(lock);
+            workAvailable.wait(guard, [&] { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+            const function<void(size_t)> *f = task;
+            size_t count = taskCount;
+            guard.unlock();
+
+            try
+            {
+                work(*f, count);
+            }
+            catch (...)
+            {
+                guard.lock();
+                if (!error)
+                    error = current_exception();
+                guard.unlock();
+                // let the others finish quickly
+                nextIndex = count;
+            }
+
+            guard.lock();
+            if (--pendingWorkers == 0)
+                workDone.notify_one();
+        }
+    }
+
+    void WorkerPool::work(const function<void(size_t)> &f, size_t count)
+    {
+        while (true)
+        {
+            size_t begin = nextIndex.fetch_add(CHUNK_SIZE);
+            if (begin >= count)
+                return;
+            size_t end = min(begin + CHUNK_SIZE, count);
+            for (size_t i = begin; i < end; i++)
+                f(i);
+        }
+    }
+
+    void WorkerPool::parallelFor(size_t count, const function<void(size_t)> &f)
+    {
+        if (threads.empty() || count <= CHUNK_SIZE)
+        {
+            for (size_t i = 0; i < count; i++)
+                f(i);
+            return;
+        }
+
+        {
+            unique_lock<mutex> guard(lock);
+            task = &f;
+            taskCount = count;
+            nextIndex = 0;
+            pendingWorkers = threads.size();
+            error = nullptr;
+            generation++;
+        }
+        workAvailable.notify_all();
+
+        exception_ptr callerError;
+        try
+        {
+            work(f, count);
+        }
+        catch (...)
+        {
+            callerError = current_exception();
+            nextIndex = count;
+        }
+
+        // every worker has to pick up this generation before f goes out of scope
+        unique_lock<mutex> guard(lock);
+        workDone.wait(guard, [&] { return pendingWorkers == 0; });
+        task = nullptr;
+        if (callerError)
+            rethrow_exception(callerError);
+        if (error)
+            rethrow_exception(error);
+    }
+
+}
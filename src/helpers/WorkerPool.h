@@ -0,0 +1,60 @@
+#ifndef HELPERS_WORKERPOOL_H_
+#define HELPERS_WORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rlora
+{
+
+    using namespace std;
+
+    /**
+     * Fixed set of worker threads for data parallel loops. The calling thread takes part
+     * in every loop and parallelFor only returns once all workers are done with it, so
+     * the loop body may use the caller's stack. The body must not touch the simulation
+     * kernel (no RNGs, logging, scheduling or module parameters).
+     */
+    class WorkerPool
+    {
+    private:
+        static const size_t CHUNK_SIZE = 16;
+
+        vector<thread> threads;
+        mutex lock;
+        condition_variable workAvailable;
+        condition_variable workDone;
+
+        const function<void(size_t)> *task = nullptr;
+        size_t taskCount = 0;
+        atomic<size_t> nextIndex;
+        uint64_t generation = 0;
+        size_t pendingWorkers = 0;
+        bool stopping = false;
+        exception_ptr error;
+
+        void run();
+        void work(const function<void(size_t)> &f, size_t count);
+
+    public:
+        WorkerPool(int numThreads);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        int getNumThreads() const { return (int)threads.size(); }
+
+        /** Calls f(i) for every i in [0, count) spread over the workers and the caller. */
+        void parallelFor(size_t count, const function<void(size_t)> &f);
+    };
+
+}
+
+#endif
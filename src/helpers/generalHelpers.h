@@ -12,6 +12,8 @@ namespace rlora
 #define BROADCAST_FRAGMENT_META_SIZE 5
 #define MAXIMUM_PACKET_SIZE 255
 
+    // Conservative wait time in ms (1 ms per byte plus 20 ms) used as a guard before giving up on a
+    // sender. This is deliberately not the time on air, see LoRaTimeOnAir for exact durations.
     inline int predictSendTime(int size)
     {
         if (size > MAXIMUM_PACKET_SIZE)
@@ -255,6 +255,15 @@ namespace rlora
         }
     }
 
+    void LoRaRadio::receiveBatchedSignal(WirelessSignal *signal)
+    {
+        Enter_Method("receiveBatchedSignal");
+        take(signal);
+        signal->setArrival(cModule::getId(), radioIn->getId(), simTime());
+        // goes through the operational state check like a signal sent directly
+        handleMessage(signal);
+    }
+
     /*
      bool LoRaRadio::handleNodeStart(IDoneCallback *doneCallback)
      {
@@ -563,13 +572,13 @@ namespace rlora
         auto signalPowerInd = macFrame->findTag<SignalPowerInd>();
         if (signalPowerInd == nullptr)
             throw cRuntimeError("signal Power indication not present");
+        // missing if the medium doesn't compute SNIR indications
         auto snirInd = macFrame->findTag<SnirInd>();
-        if (snirInd == nullptr)
-            throw cRuntimeError("snir indication not present");
 
         auto errorTag = macFrame->findTag<ErrorRateInd>();
 
-        emit(minSNIRSignal, snirInd->getMinimumSnir());
+        if (snirInd)
+            emit(minSNIRSignal, snirInd->getMinimumSnir());
         if (errorTag && !std::isnan(errorTag->getPacketErrorRate()))
             emit(packetErrorRateSignal, errorTag->getPacketErrorRate());
         if (errorTag && !std::isnan(errorTag->getBitErrorRate()))
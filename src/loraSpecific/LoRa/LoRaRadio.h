@@ -158,6 +158,12 @@ public:
     virtual IRadioSignal::SignalPart getReceivedSignalPart() const override;
 
     virtual void decapsulate(Packet *packet) const override;
+
+    /**
+     * Delivers a signal the medium batched with the signals of other receivers,
+     * as if it had arrived on the radio gate now.
+     */
+    virtual void receiveBatchedSignal(WirelessSignal *signal);
 //    virtual void setRadioMode(RadioMode newRadioMode) const override;
 };
 
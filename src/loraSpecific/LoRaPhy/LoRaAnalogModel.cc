@@ -21,65 +21,52 @@
 #include "LoRaReceiver.h"
 #include "../LoRaPhy/LoRaAnalogModel.h"
 #include "../LoRa/LoRaRadio.h"
+#include "LoRaObjectPool.h"
+#include "LoRaSensitivityTable.h"
+
+#include <algorithm>
 
 namespace rlora {
 
 Define_Module(LoRaAnalogModel);
 
+void LoRaAnalogModel::initialize(int stage)
+{
+    ScalarAnalogModelBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        loRaPathLoss = dynamic_cast<const LoRaLogNormalShadowing *>(getParentModule()->getSubmodule("pathLoss"));
+        cacheLinkGains = par("cacheLinkGains");
+        if (cacheLinkGains && loRaPathLoss == nullptr)
+            throw cRuntimeError("cacheLinkGains requires the LoRaLogNormalShadowing path loss model");
+    }
+}
+
+double LoRaAnalogModel::getLinkGain(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
+{
+    const Coord& transmitterPosition = transmission->getStartPosition();
+    const Coord& receiverPosition = arrival->getStartPosition();
+    const Quaternion& transmitterOrientation = transmission->getStartOrientation();
+    const Quaternion& receiverOrientation = arrival->getStartOrientation();
+    uint64_t key = ((uint64_t)(uint32_t)transmission->getTransmitterId() << 32) | (uint32_t)receiverRadio->getId();
+    auto it = linkGains.find(key);
+    if (it != linkGains.end() && it->second.transmitterPosition == transmitterPosition && it->second.receiverPosition == receiverPosition
+            && it->second.transmitterOrientation == transmitterOrientation && it->second.receiverOrientation == receiverOrientation)
+        return it->second.gain;
+    double transmitterAntennaGain = computeAntennaGain(transmission->getTransmitterAntennaGain(), transmitterPosition, receiverPosition, transmitterOrientation);
+    double receiverAntennaGain = computeAntennaGain(receiverRadio->getAntenna()->getGain().get(), receiverPosition, transmitterPosition, receiverOrientation);
+    double pathLoss = math::dB2fraction(-loRaPathLoss->computeDeterministicPathLoss(m(receiverPosition.distance(transmitterPosition))));
+    double gain = transmitterAntennaGain * receiverAntennaGain * pathLoss;
+    linkGains[key] = LinkGain{transmitterPosition, receiverPosition, transmitterOrientation, receiverOrientation, gain};
+    return gain;
+}
+
 std::ostream& LoRaAnalogModel::printToStream(std::ostream& stream, int level, int evFlags) const
 {
     return stream << "LoRaAnalogModel";
 }
 
 const W LoRaAnalogModel::getBackgroundNoisePower(const LoRaBandListening *listening) const {
-    //const LoRaBandListening *loRaListening = check_and_cast<const LoRaBandListening *>(listening);
-    //Sensitivity values from Semtech SX1272/73 datasheet, table 10, Rev 3.1, March 2017
-    W noisePower = W(math::dBmW2mW(-126.5) / 1000);
-    if(listening->getLoRaSF() == 6)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-121) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-118) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-111) / 1000);
-    }
-
-    if (listening->getLoRaSF() == 7)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-124) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-122) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-116) / 1000);
-    }
-
-    if(listening->getLoRaSF() == 8)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-127) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-125) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-119) / 1000);
-    }
-    if(listening->getLoRaSF() == 9)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-130) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-128) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-122) / 1000);
-    }
-    if(listening->getLoRaSF() == 10)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-133) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-130) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-125) / 1000);
-    }
-    if(listening->getLoRaSF() == 11)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-135) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-132) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-128) / 1000);
-    }
-    if(listening->getLoRaSF() == 12)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-137) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-135) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-129) / 1000);
-    }
-    return noisePower;
+    return LoRaSensitivityTable::getNoiseFloor(listening->getLoRaSF(), listening->getLoRaBW());
 }
 
 W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
@@ -90,9 +77,15 @@ W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITra
     const Coord receptionStartPosition = arrival->getStartPosition();
     const Coord receptionEndPosition = arrival->getEndPosition();
 
+    if (cacheLinkGains) {
+        double shadowing = loRaPathLoss->computeShadowing(transmission->getTransmitterId(), transmission->getStartPosition(), receiverRadio->getId(), receptionStartPosition);
+        double obstacleLoss = radioMedium->getObstacleLoss() ? radioMedium->getObstacleLoss()->computeObstacleLoss(narrowbandSignalAnalogModel->getCenterFrequency(), transmission->getStartPosition(), receptionStartPosition) : 1;
+        return scalarSignalAnalogModel->getPower() * std::min(1.0, getLinkGain(receiverRadio, transmission, arrival) * math::dB2fraction(-shadowing) * obstacleLoss);
+    }
+
     double transmitterAntennaGain = computeAntennaGain(transmission->getTransmitterAntennaGain(), transmission->getStartPosition(), arrival->getStartPosition(), transmission->getStartOrientation());
     double receiverAntennaGain = computeAntennaGain(receiverRadio->getAntenna()->getGain().get(), arrival->getStartPosition(), transmission->getStartPosition(), arrival->getStartOrientation());
-    double pathLoss = radioMedium->getPathLoss()->computePathLoss(transmission, arrival);
+    double pathLoss = loRaPathLoss != nullptr ? loRaPathLoss->computePathLoss(transmission, arrival, receiverRadio) : radioMedium->getPathLoss()->computePathLoss(transmission, arrival);
     double obstacleLoss = radioMedium->getObstacleLoss() ? radioMedium->getObstacleLoss()->computeObstacleLoss(narrowbandSignalAnalogModel->getCenterFrequency(), transmission->getStartPosition(), receptionStartPosition) : 1;
     W transmissionPower = scalarSignalAnalogModel->getPower();
     W rxPower=transmissionPower * std::min(1.0, transmitterAntennaGain * receiverAntennaGain * pathLoss * obstacleLoss);
@@ -106,7 +99,21 @@ W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITra
     return rxPower;
 }
 
+W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival, double shadowing) const
+{
+    const IScalarSignal *scalarSignalAnalogModel = check_and_cast<const IScalarSignal *>(transmission->getAnalogModel());
+    double transmitterAntennaGain = computeAntennaGain(transmission->getTransmitterAntennaGain(), transmission->getStartPosition(), arrival->getStartPosition(), transmission->getStartOrientation());
+    double receiverAntennaGain = computeAntennaGain(receiverRadio->getAntenna()->getGain().get(), arrival->getStartPosition(), transmission->getStartPosition(), arrival->getStartOrientation());
+    double pathLoss = loRaPathLoss->computePathLoss(transmission, arrival, shadowing);
+    return scalarSignalAnalogModel->getPower() * std::min(1.0, transmitterAntennaGain * receiverAntennaGain * pathLoss);
+}
+
 const IReception *LoRaAnalogModel::computeReception(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
+{
+    return createReception(receiverRadio, transmission, arrival, computeReceptionPower(receiverRadio, transmission, arrival));
+}
+
+const IReception *LoRaAnalogModel::createReception(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival, W receivedPower) const
 {
     const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
     const simtime_t receptionStartTime = arrival->getStartTime();
@@ -115,7 +122,6 @@ const IReception *LoRaAnalogModel::computeReception(const IRadio *receiverRadio,
     const Quaternion receptionEndOrientation = arrival->getEndOrientation();
     const Coord receptionStartPosition = arrival->getStartPosition();
     const Coord receptionEndPosition = arrival->getEndPosition();
-    W receivedPower = computeReceptionPower(receiverRadio, transmission, arrival);
     Hz LoRaCF = loRaTransmission->getLoRaCF();
     int LoRaSF = loRaTransmission->getLoRaSF();
     Hz LoRaBW = loRaTransmission->getLoRaBW();
@@ -123,14 +129,14 @@ const IReception *LoRaAnalogModel::computeReception(const IRadio *receiverRadio,
     return new LoRaReception(receiverRadio, transmission, receptionStartTime, receptionEndTime, receptionStartPosition, receptionEndPosition, receptionStartOrientation, receptionEndOrientation, LoRaCF, LoRaBW, receivedPower, LoRaSF, LoRaCR);
 }
 
-const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const IInterference *interference) const
+void LoRaAnalogModel::collectPowerChanges(const IListening *listening, const IInterference *interference, simtime_t& noiseStartTime, simtime_t& noiseEndTime) const
 {
     const LoRaBandListening *bandListening = check_and_cast<const LoRaBandListening *>(listening);
     Hz commonCarrierFrequency = bandListening->getLoRaCF();
     Hz commonBandwidth = bandListening->getLoRaBW();
-    simtime_t noiseStartTime = SimTime::getMaxTime();
-    simtime_t noiseEndTime = 0;
-    std::map<simtime_t, W> *powerChanges = new std::map<simtime_t, W>();
+    noiseStartTime = SimTime::getMaxTime();
+    noiseEndTime = 0;
+    powerChanges.clear();
     const std::vector<const IReception *> *interferingReceptions = interference->getInterferingReceptions();
     for (auto reception : *interferingReceptions) {
         const ISignalAnalogModel *signalAnalogModel = reception->getAnalogModel();
@@ -140,57 +146,92 @@ const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const I
         Hz signalBandwidth = loRaReception->getLoRaBW();
         if((commonCarrierFrequency == signalCarrierFrequency && commonBandwidth == signalBandwidth))
         {
-            const IScalarSignal *scalarSignalAnalogModel = check_and_cast<const IScalarSignal *>(signalAnalogModel);
-            W power = scalarSignalAnalogModel->getPower();
+            W power = loRaReception->getPower();
             simtime_t startTime = reception->getStartTime();
             simtime_t endTime = reception->getEndTime();
             if (startTime < noiseStartTime)
                 noiseStartTime = startTime;
             if (endTime > noiseEndTime)
                 noiseEndTime = endTime;
-            std::map<simtime_t, W>::iterator itStartTime = powerChanges->find(startTime);
-            if (itStartTime != powerChanges->end())
-                itStartTime->second += power;
-            else
-                powerChanges->insert(std::pair<simtime_t, W>(startTime, power));
-            std::map<simtime_t, W>::iterator itEndTime = powerChanges->find(endTime);
-            if (itEndTime != powerChanges->end())
-                itEndTime->second -= power;
-            else
-                powerChanges->insert(std::pair<simtime_t, W>(endTime, -power));
+            powerChanges.push_back(std::make_pair(startTime, power));
+            powerChanges.push_back(std::make_pair(endTime, -power));
         }
         else if (areOverlappingBands(commonCarrierFrequency, commonBandwidth, narrowbandSignalAnalogModel->getCenterFrequency(), narrowbandSignalAnalogModel->getBandwidth()))
             throw cRuntimeError("Overlapping bands are not supported");
     }
-
-    simtime_t startTime = listening->getStartTime();
-    simtime_t endTime = listening->getEndTime();
-    std::map<simtime_t, W> *backgroundNoisePowerChanges = new std::map<simtime_t, W>();
     const W noisePower = getBackgroundNoisePower(bandListening);
-    backgroundNoisePowerChanges->insert(std::pair<simtime_t, W>(startTime, noisePower));
-    backgroundNoisePowerChanges->insert(std::pair<simtime_t, W>(endTime, -noisePower));
-
-    for (const auto & backgroundNoisePowerChange : *backgroundNoisePowerChanges) {
-        std::map<simtime_t, W>::iterator jt = powerChanges->find(backgroundNoisePowerChange.first);
-        if (jt != powerChanges->end())
-            jt->second += backgroundNoisePowerChange.second;
+    powerChanges.push_back(std::make_pair(listening->getStartTime(), noisePower));
+    powerChanges.push_back(std::make_pair(listening->getEndTime(), -noisePower));
+
+    // stable, so the summation order at equal times is the same as with the map
+    std::stable_sort(powerChanges.begin(), powerChanges.end(), [] (const std::pair<simtime_t, W>& a, const std::pair<simtime_t, W>& b) {
+        return a.first < b.first;
+    });
+    size_t n = 0;
+    for (size_t i = 0; i < powerChanges.size(); i++) {
+        if (n != 0 && powerChanges[n - 1].first == powerChanges[i].first)
+            powerChanges[n - 1].second += powerChanges[i].second;
         else
-            powerChanges->insert(std::pair<simtime_t, W>(backgroundNoisePowerChange.first, backgroundNoisePowerChange.second));
+            powerChanges[n++] = powerChanges[i];
     }
+    powerChanges.resize(n);
+}
+
+const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const IInterference *interference) const
+{
+    const LoRaBandListening *bandListening = check_and_cast<const LoRaBandListening *>(listening);
+    simtime_t noiseStartTime;
+    simtime_t noiseEndTime;
+    collectPowerChanges(listening, interference, noiseStartTime, noiseEndTime);
+
+    // the sorted changes are appended at the end, so every insert is amortized constant
+    std::map<simtime_t, W> *noisePowerChanges = new std::map<simtime_t, W>();
+    for (const auto& powerChange : powerChanges)
+        noisePowerChanges->emplace_hint(noisePowerChanges->end(), powerChange.first, powerChange.second);
 
     EV_TRACE << "Noise power begin " << endl;
     W noise = W(0);
-    for (std::map<simtime_t, W>::const_iterator it = powerChanges->begin(); it != powerChanges->end(); it++) {
-        noise += it->second;
-        EV_TRACE << "Noise at " << it->first << " = " << noise << endl;
+    for (const auto& powerChange : powerChanges) {
+        noise += powerChange.second;
+        EV_TRACE << "Noise at " << powerChange.first << " = " << noise << endl;
     }
     EV_TRACE << "Noise power end" << endl;
-    return new ScalarNoise(noiseStartTime, noiseEndTime, commonCarrierFrequency, commonBandwidth, powerChanges);
+    return new LoRaPooled<ScalarNoise>(noiseStartTime, noiseEndTime, bandListening->getLoRaCF(), bandListening->getLoRaBW(), noisePowerChanges);
+}
+
+W LoRaAnalogModel::computeMaxNoisePower(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime) const
+{
+    simtime_t noiseStartTime;
+    simtime_t noiseEndTime;
+    collectPowerChanges(listening, interference, noiseStartTime, noiseEndTime);
+    W noisePower = W(0);
+    W maxNoisePower = W(NaN);
+    for (const auto& powerChange : powerChanges) {
+        noisePower += powerChange.second;
+        if (powerChange.first >= startTime && powerChange.first < endTime && (std::isnan(maxNoisePower.get()) || noisePower > maxNoisePower))
+            maxNoisePower = noisePower;
+    }
+    return maxNoisePower;
+}
+
+W LoRaAnalogModel::computeMinNoisePower(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime) const
+{
+    simtime_t noiseStartTime;
+    simtime_t noiseEndTime;
+    collectPowerChanges(listening, interference, noiseStartTime, noiseEndTime);
+    W noisePower = W(0);
+    W minNoisePower = W(NaN);
+    for (const auto& powerChange : powerChanges) {
+        noisePower += powerChange.second;
+        if (powerChange.first >= startTime && powerChange.first < endTime && (std::isnan(minNoisePower.get()) || noisePower < minNoisePower))
+            minNoisePower = noisePower;
+    }
+    return minNoisePower;
 }
 
 const ISnir *LoRaAnalogModel::computeSNIR(const IReception *reception, const INoise *noise) const
 {
-    return new ScalarSnir(reception, noise);
+    return new LoRaPooled<ScalarSnir>(reception, noise);
 }
 
 } // namespace inet
@@ -20,18 +20,79 @@
 #include "inet/physicallayer/wireless/common/radio/packetlevel/BandListening.h"
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarNoise.h"
 
+#include <unordered_map>
+
 #include "LoRaBandListening.h"
+#include "LoRaLogNormalShadowing.h"
 
 namespace rlora {
 
 class LoRaAnalogModel : public ScalarAnalogModelBase
 {
+  protected:
+    // set if the medium uses the LoRa shadowing model, which needs to know the receiver of the link
+    const LoRaLogNormalShadowing *loRaPathLoss = nullptr;
+
+    /**
+     * With cacheLinkGains the antenna gains and the distance dependent path loss
+     * of every (transmitter, receiver) link are kept and reused as long as neither
+     * end moves or rotates, only the shadowing is added per reception.
+     */
+    struct LinkGain
+    {
+        Coord transmitterPosition;
+        Coord receiverPosition;
+        Quaternion transmitterOrientation;
+        Quaternion receiverOrientation;
+        double gain;
+    };
+    bool cacheLinkGains = false;
+    // keyed by the packed (transmitter, receiver) radio id pair, antenna gains aren't reciprocal
+    mutable std::unordered_map<uint64_t, LinkGain> linkGains;
+
+  protected:
+    typedef std::vector<std::pair<simtime_t, W>> PowerChanges;
+
+    // scratch buffer reused by every noise computation to avoid per listening allocations
+    mutable PowerChanges powerChanges;
+
+  protected:
+    virtual void initialize(int stage) override;
+
+    /**
+     * Fills powerChanges with the interference and background noise power changes of
+     * the listening, sorted by time with equal times merged. noiseStartTime and
+     * noiseEndTime span the interferers in the band only.
+     */
+    void collectPowerChanges(const IListening *listening, const IInterference *interference, simtime_t& noiseStartTime, simtime_t& noiseEndTime) const;
+
+    /**
+     * Antenna gains times the deterministic path loss of the link, recomputed only
+     * if the transmitter or the receiver moved or rotated since the last reception.
+     */
+    double getLinkGain(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const;
+
   public:
     const W getBackgroundNoisePower(const LoRaBandListening *listening) const;
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
     virtual W computeReceptionPower(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival) const override;
     virtual const IReception *computeReception(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival) const override;
+    const IReception *createReception(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival, W receivedPower) const;
+
+    /**
+     * Reception power with the given link shadowing in dB. Draws no random numbers,
+     * doesn't log and ignores obstacles, so it can be called from worker threads.
+     * Requires the LoRa shadowing model.
+     */
+    W computeReceptionPower(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival, double shadowing) const;
+    const LoRaLogNormalShadowing *getLoRaPathLoss() const { return loRaPathLoss; }
     const INoise *computeNoise(const IListening *listening, const IInterference *interference) const override;
+    /**
+     * Same result as computeNoise(listening, interference)->computeMaxPower(startTime, endTime)
+     * and computeMinPower respectively but computed with a linear sweep, no noise object is built.
+     */
+    W computeMaxNoisePower(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime) const;
+    W computeMinNoisePower(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime) const;
     virtual const ISnir *computeSNIR(const IReception *reception, const INoise *noise) const override;
 };
 
@@ -18,6 +18,7 @@
 
 #include "inet/physicallayer/wireless/common/radio/packetlevel/BandListening.h"
 #include "inet/physicallayer/wireless/common/base/packetlevel/ListeningBase.h"
+#include "LoRaObjectPool.h"
 
 using namespace inet;
 using namespace inet::physicallayer;
@@ -40,6 +41,9 @@ class LoRaBandListening : public BandListening
     virtual Hz getLoRaCF() const { return centerFrequency; }
     virtual int getLoRaSF() const { return LoRaSF; }
     virtual Hz getLoRaBW() const { return bandwidth; }
+
+    static void *operator new(size_t size) { return LoRaObjectPool<LoRaBandListening>::allocate(size); }
+    static void operator delete(void *object, size_t size) { LoRaObjectPool<LoRaBandListening>::deallocate(object, size); }
 };
 
 } // namespace inet
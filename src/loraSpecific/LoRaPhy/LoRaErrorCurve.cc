@@ -0,0 +1,87 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaErrorCurve.h"
+#include "inet/common/INETMath.h"
+#include <cmath>
+
+namespace rlora {
+
+LoRaErrorCurve::Table::Table() :
+    numPoints((int)std::lround((MAX_SNIR_DB - MIN_SNIR_DB) / SNIR_STEP_DB) + 1),
+    symbolErrorRates(LoRaSensitivityTable::NUM_SF * numPoints),
+    bitErrorRates(LoRaSensitivityTable::NUM_SF * numPoints),
+    logBitSuccessRates(LoRaSensitivityTable::NUM_SF * numPoints)
+{
+    for (int sf = LoRaSensitivityTable::MIN_SF; sf <= LoRaSensitivityTable::MAX_SF; sf++)
+        for (int i = 0; i < numPoints; i++) {
+            double snir = math::dB2fraction(MIN_SNIR_DB + i * SNIR_STEP_DB);
+            int index = (sf - LoRaSensitivityTable::MIN_SF) * numPoints + i;
+            symbolErrorRates[index] = computeSymbolErrorRate(sf, snir);
+            bitErrorRates[index] = computeBitErrorRate(sf, snir);
+            logBitSuccessRates[index] = std::log1p(-bitErrorRates[index]);
+        }
+}
+
+double LoRaErrorCurve::Table::interpolate(const std::vector<double>& values, int spreadFactor, double snirDb) const
+{
+    const double *curve = values.data() + (spreadFactor - LoRaSensitivityTable::MIN_SF) * numPoints;
+    double position = (snirDb - MIN_SNIR_DB) / SNIR_STEP_DB;
+    // the curves are flat beyond both ends of the grid
+    if (!(position > 0))
+        return curve[0];
+    if (position >= numPoints - 1)
+        return curve[numPoints - 1];
+    int i = (int)position;
+    double fraction = position - i;
+    return curve[i] + (curve[i + 1] - curve[i]) * fraction;
+}
+
+const LoRaErrorCurve::Table& LoRaErrorCurve::getTable()
+{
+    static const Table table;
+    return table;
+}
+
+double LoRaErrorCurve::computeSymbolErrorRate(int spreadFactor, double snir)
+{
+    double x = std::sqrt(std::ldexp(2.0, spreadFactor) * snir) - std::sqrt(1.386 * spreadFactor + 1.154);
+    // Q(x) = erfc(x / sqrt(2)) / 2
+    return 0.5 * std::erfc(x / M_SQRT2);
+}
+
+double LoRaErrorCurve::computeBitErrorRate(int spreadFactor, double snir)
+{
+    double numSymbols = std::ldexp(1.0, spreadFactor);
+    return computeSymbolErrorRate(spreadFactor, snir) * (numSymbols / 2) / (numSymbols - 1);
+}
+
+double LoRaErrorCurve::getSymbolErrorRate(int spreadFactor, double snir)
+{
+    return isTabulated(spreadFactor) ? getTable().getSymbolErrorRate(spreadFactor, math::fraction2dB(snir)) : computeSymbolErrorRate(spreadFactor, snir);
+}
+
+double LoRaErrorCurve::getBitErrorRate(int spreadFactor, double snir)
+{
+    return isTabulated(spreadFactor) ? getTable().getBitErrorRate(spreadFactor, math::fraction2dB(snir)) : computeBitErrorRate(spreadFactor, snir);
+}
+
+double LoRaErrorCurve::getPacketErrorRate(int spreadFactor, double snir, int64_t numBits)
+{
+    double logBitSuccessRate = isTabulated(spreadFactor) ? getTable().getLogBitSuccessRate(spreadFactor, math::fraction2dB(snir)) : std::log1p(-computeBitErrorRate(spreadFactor, snir));
+    return -std::expm1(numBits * logBitSuccessRate);
+}
+
+} // namespace rlora
@@ -0,0 +1,78 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAERRORCURVE_H_
+#define LORAPHY_LORAERRORCURVE_H_
+
+#include "LoRaSensitivityTable.h"
+#include <vector>
+
+namespace rlora {
+
+/**
+ * Error rates of LoRa chirp spread spectrum in AWGN as a function of the SNIR
+ * (signal to noise and interference power ratio in the receiver bandwidth).
+ * The symbol error rate uses the approximation of Elshabrawy and Robert,
+ * "Closed-Form Approximation of LoRa Modulation BER Performance", 2018:
+ *
+ *   SER = Q(sqrt(2^(SF+1) * SNIR) - sqrt(1.386 * SF + 1.154))
+ *
+ * and BER = SER * 2^(SF-1) / (2^SF - 1) for orthogonal signaling. Coding and
+ * interleaving gains are not modeled. The curves of SF6-12 are tabulated on
+ * first use over MIN_SNIR_DB..MAX_SNIR_DB and linearly interpolated, other
+ * spreading factors are computed with the formula.
+ */
+class LoRaErrorCurve
+{
+  public:
+    static constexpr double MIN_SNIR_DB = -40;
+    static constexpr double MAX_SNIR_DB = 20;
+    static constexpr double SNIR_STEP_DB = 0.05;
+
+  protected:
+    class Table
+    {
+      protected:
+        int numPoints;
+        std::vector<double> symbolErrorRates;
+        std::vector<double> bitErrorRates;
+        // log(1 - BER), the packet error rate of n bits is 1 - exp(n * log(1 - BER))
+        std::vector<double> logBitSuccessRates;
+
+        double interpolate(const std::vector<double>& values, int spreadFactor, double snirDb) const;
+
+      public:
+        Table();
+        double getSymbolErrorRate(int spreadFactor, double snirDb) const { return interpolate(symbolErrorRates, spreadFactor, snirDb); }
+        double getBitErrorRate(int spreadFactor, double snirDb) const { return interpolate(bitErrorRates, spreadFactor, snirDb); }
+        double getLogBitSuccessRate(int spreadFactor, double snirDb) const { return interpolate(logBitSuccessRates, spreadFactor, snirDb); }
+    };
+
+    static const Table& getTable();
+    static bool isTabulated(int spreadFactor) { return spreadFactor >= LoRaSensitivityTable::MIN_SF && spreadFactor <= LoRaSensitivityTable::MAX_SF; }
+
+  public:
+    /** The snir is a linear power ratio. */
+    static double computeSymbolErrorRate(int spreadFactor, double snir);
+    static double computeBitErrorRate(int spreadFactor, double snir);
+
+    static double getSymbolErrorRate(int spreadFactor, double snir);
+    static double getBitErrorRate(int spreadFactor, double snir);
+    static double getPacketErrorRate(int spreadFactor, double snir, int64_t numBits);
+};
+
+} // namespace rlora
+
+#endif /* LORAPHY_LORAERRORCURVE_H_ */
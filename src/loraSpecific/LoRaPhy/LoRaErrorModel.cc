@@ -0,0 +1,53 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaErrorModel.h"
+#include "LoRaErrorCurve.h"
+#include "LoRaReception.h"
+
+namespace rlora {
+
+Define_Module(LoRaErrorModel);
+
+std::ostream& LoRaErrorModel::printToStream(std::ostream& stream, int level, int evFlags) const
+{
+    return stream << "LoRaErrorModel";
+}
+
+int LoRaErrorModel::getSpreadFactor(const ISnir *snir) const
+{
+    return check_and_cast<const LoRaReception *>(snir->getReception())->getLoRaSF();
+}
+
+double LoRaErrorModel::computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    Enter_Method_Silent();
+    auto packet = snir->getReception()->getTransmission()->getPacket();
+    return LoRaErrorCurve::getPacketErrorRate(getSpreadFactor(snir), getScalarSnir(snir), packet->getTotalLength().get());
+}
+
+double LoRaErrorModel::computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    Enter_Method_Silent();
+    return LoRaErrorCurve::getBitErrorRate(getSpreadFactor(snir), getScalarSnir(snir));
+}
+
+double LoRaErrorModel::computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    Enter_Method_Silent();
+    return LoRaErrorCurve::getSymbolErrorRate(getSpreadFactor(snir), getScalarSnir(snir));
+}
+
+} // namespace rlora
@@ -15,6 +15,7 @@
 
 #include "LoRaLogNormalShadowing.h"
 #include "inet/common/INETMath.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
 
 namespace rlora {
 
@@ -31,6 +32,12 @@ void LoRaLogNormalShadowing::initialize(int stage)
         sigma = par("sigma");
         gamma = par("gamma");
         d0 = m(par("d0"));
+        coherenceTime = par("coherenceTime");
+        correlatedShadowing = par("correlatedShadowing");
+        decorrelationDistance = m(par("decorrelationDistance"));
+        shadowingGridResolution = m(par("shadowingGridResolution"));
+        if (correlatedShadowing && (decorrelationDistance <= m(0) || shadowingGridResolution <= m(0)))
+            throw cRuntimeError("decorrelationDistance and shadowingGridResolution must be positive");
     }
 }
 
@@ -43,22 +50,110 @@ std::ostream& LoRaLogNormalShadowing::printToStream(std::ostream &stream, int le
 }
 
 
-double LoRaLogNormalShadowing::computePathLoss(mps propagationSpeed, Hz frequency, m distance) const
+double LoRaLogNormalShadowing::computeDeterministicPathLoss(m distance) const
 {
     double PL_d0_db = 112;
-    double PL_db = PL_d0_db + 10 * gamma * log10(unit(distance / d0).get()) + normal(0.0, sigma);
+    return PL_d0_db + 10 * gamma * log10(unit(distance / d0).get());
+}
 
-    // Compute max communication range using the transmission power
-    m maxRange = computeRange(W(0.112202)); // 0.112202 W = 20.5 dBm total (20 dBm + 0.5 dBi)
+double LoRaLogNormalShadowing::computePathLoss(mps propagationSpeed, Hz frequency, m distance) const
+{
+    // no link known here, so the shadowing is drawn independently for every call
+    double PL_db = computeDeterministicPathLoss(distance) + normal(0.0, sigma);
 
     EV << "Distance: " << distance << endl;
-    EV << "maxRange " << maxRange << endl;
+    EV << "maxRange " << computeRange(W(0.112202)) << endl; // 0.112202 W = 20.5 dBm total (20 dBm + 0.5 dBi)
 
     return math::dB2fraction(-PL_db);
 }
 
+double LoRaLogNormalShadowing::computePathLoss(const ITransmission *transmission, const IArrival *arrival, const IRadio *receiver) const
+{
+    const Coord& transmitterPosition = transmission->getStartPosition();
+    const Coord& receiverPosition = arrival->getStartPosition();
+    m distance = m(receiverPosition.distance(transmitterPosition));
+    double PL_db = computeDeterministicPathLoss(distance) + computeShadowing(transmission->getTransmitterId(), transmitterPosition, receiver->getId(), receiverPosition);
+
+    EV << "Distance: " << distance << endl;
+    EV << "maxRange " << computeRange(W(0.112202)) << endl; // 0.112202 W = 20.5 dBm total (20 dBm + 0.5 dBi)
+
+    return math::dB2fraction(-PL_db);
+}
+
+double LoRaLogNormalShadowing::computePathLoss(const ITransmission *transmission, const IArrival *arrival, double shadowing) const
+{
+    m distance = m(arrival->getStartPosition().distance(transmission->getStartPosition()));
+    return math::dB2fraction(-(computeDeterministicPathLoss(distance) + shadowing));
+}
+
+double LoRaLogNormalShadowing::computeShadowing(int transmitterId, const Coord& transmitterPosition, int receiverId, const Coord& receiverPosition) const
+{
+    if (correlatedShadowing) {
+        if (shadowingGrid.empty())
+            buildShadowingGrid();
+        // the field has unit variance, the sum of two independent samples is scaled back to it
+        return sigma * (getShadowingGridValue(transmitterPosition) + getShadowingGridValue(receiverPosition)) / sqrt(2.0);
+    }
+    if (coherenceTime <= 0)
+        return normal(0.0, sigma);
+    uint64_t key = ((uint64_t)(uint32_t)std::min(transmitterId, receiverId) << 32) | (uint32_t)std::max(transmitterId, receiverId);
+    simtime_t now = simTime();
+    auto it = shadowingCache.find(key);
+    if (it == shadowingCache.end())
+        it = shadowingCache.emplace(key, ShadowingSample{normal(0.0, sigma), now}).first;
+    else if (now - it->second.drawTime >= coherenceTime)
+        it->second = ShadowingSample{normal(0.0, sigma), now};
+    return it->second.shadowing;
+}
+
+void LoRaLogNormalShadowing::buildShadowingGrid() const
+{
+    const IMediumLimitCache *mediumLimitCache = check_and_cast<IRadioMedium *>(getParentModule())->getMediumLimitCache();
+    Coord minArea = mediumLimitCache->getMinConstraintArea();
+    Coord maxArea = mediumLimitCache->getMaxConstraintArea();
+    if (!std::isfinite(minArea.x) || !std::isfinite(minArea.y) || !std::isfinite(maxArea.x) || !std::isfinite(maxArea.y))
+        throw cRuntimeError("Correlated shadowing requires a finite constraint area");
+    double resolution = shadowingGridResolution.get();
+    shadowingGridOrigin = minArea;
+    shadowingGridSizeX = (int)ceil((maxArea.x - minArea.x) / resolution) + 1;
+    shadowingGridSizeY = (int)ceil((maxArea.y - minArea.y) / resolution) + 1;
+    shadowingGrid.resize((size_t)shadowingGridSizeX * shadowingGridSizeY);
+    for (auto& value : shadowingGrid)
+        value = normal(0.0, 1.0);
+
+    // separable first order autoregressive filter along x then y, the result keeps unit
+    // variance and has a correlation of exp(-d / decorrelationDistance) along the axes
+    double rho = exp(-resolution / decorrelationDistance.get());
+    double innovation = sqrt(1 - rho * rho);
+    for (int y = 0; y < shadowingGridSizeY; y++)
+        for (int x = 1; x < shadowingGridSizeX; x++) {
+            size_t i = (size_t)y * shadowingGridSizeX + x;
+            shadowingGrid[i] = rho * shadowingGrid[i - 1] + innovation * shadowingGrid[i];
+        }
+    for (int y = 1; y < shadowingGridSizeY; y++)
+        for (int x = 0; x < shadowingGridSizeX; x++) {
+            size_t i = (size_t)y * shadowingGridSizeX + x;
+            shadowingGrid[i] = rho * shadowingGrid[i - shadowingGridSizeX] + innovation * shadowingGrid[i];
+        }
+    EV_DEBUG << "Built " << shadowingGridSizeX << "x" << shadowingGridSizeY << " correlated shadowing grid" << endl;
+}
+
+double LoRaLogNormalShadowing::getShadowingGridValue(const Coord& position) const
+{
+    double resolution = shadowingGridResolution.get();
+    int x = (int)round((position.x - shadowingGridOrigin.x) / resolution);
+    int y = (int)round((position.y - shadowingGridOrigin.y) / resolution);
+    x = std::max(0, std::min(x, shadowingGridSizeX - 1));
+    y = std::max(0, std::min(y, shadowingGridSizeY - 1));
+    return shadowingGrid[(size_t)y * shadowingGridSizeX + x];
+}
+
 m LoRaLogNormalShadowing::computeRange(W transmissionPower) const
 {
+    auto it = rangeCache.find(transmissionPower.get());
+    if (it != rangeCache.end())
+        return it->second;
+
     double PL_d0_db = 112;
     double max_sensitivity = -124.5;
     // war vorher:
@@ -68,6 +163,7 @@ m LoRaLogNormalShadowing::computeRange(W transmissionPower) const
 
     double rhs = (trans_power_db - PL_d0_db - max_sensitivity) / (10 * gamma);
     double distance = d0.get() * pow(10, rhs);
+    rangeCache[transmissionPower.get()] = m(distance);
     return m(distance);
 }
 
@@ -16,7 +16,13 @@
 #ifndef LORAPHY_LORALOGNORMALSHADOWING_H_
 #define LORAPHY_LORALOGNORMALSHADOWING_H_
 
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
 #include "inet/physicallayer/wireless/common/pathloss/FreeSpacePathLoss.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
 
 using namespace inet;
 using namespace inet::physicallayer;
@@ -24,22 +30,69 @@ namespace rlora {
 
 /**
  * This class implements the log normal shadowing model.
+ *
+ * The shadowing of a link is either drawn per link and kept for coherenceTime
+ * or, with correlatedShadowing, read from a spatially correlated field that is
+ * precomputed on a grid over the constraint area.
  */
 class LoRaLogNormalShadowing : public FreeSpacePathLoss
 {
+  protected:
+    struct ShadowingSample
+    {
+        double shadowing; // dB
+        simtime_t drawTime;
+    };
+
   protected:
     m d0;
     double gamma;
     double sigma;
+    simtime_t coherenceTime;
+    bool correlatedShadowing;
+    m decorrelationDistance;
+    m shadowingGridResolution;
+
+    // keyed by the packed (min, max) radio id pair, shadowing is reciprocal
+    mutable std::unordered_map<uint64_t, ShadowingSample> shadowingCache;
+    // keyed by the transmission power in W
+    mutable std::map<double, m> rangeCache;
+
+    // unit variance field, built lazily because the constraint area is only known after the radios registered
+    mutable std::vector<double> shadowingGrid;
+    mutable int shadowingGridSizeX = 0;
+    mutable int shadowingGridSizeY = 0;
+    mutable Coord shadowingGridOrigin;
 
   protected:
     virtual void initialize(int stage) override;
 
+    virtual void buildShadowingGrid() const;
+    virtual double getShadowingGridValue(const Coord& position) const;
+
   public:
     LoRaLogNormalShadowing();
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
     //virtual double computePathLoss(const ITransmission *transmission, const IArrival *arrival) const override;
     virtual double computePathLoss(mps propagationSpeed, Hz frequency, m distance) const override;
+
+    /**
+     * Path loss of the link from the transmitter to the given receiver with the
+     * shadowing of that link, this is what the analog model uses.
+     */
+    virtual double computePathLoss(const ITransmission *transmission, const IArrival *arrival, const IRadio *receiver) const;
+
+    /**
+     * Path loss of the link with the given shadowing, draws no random numbers and
+     * doesn't log, so it can be called from worker threads.
+     */
+    double computePathLoss(const ITransmission *transmission, const IArrival *arrival, double shadowing) const;
+
+    /** Distance dependent part of the path loss in dB. */
+    double computeDeterministicPathLoss(m distance) const;
+    /** Shadowing of the link in dB. */
+    virtual double computeShadowing(int transmitterId, const Coord& transmitterPosition, int receiverId, const Coord& receiverPosition) const;
+
     m computeRange(W transmissionPower) const;
 };
 
@@ -14,7 +14,10 @@
 // 
 #include "LoRaMedium.h"
 #include "../LoRa/LoRaMacFrame_m.h"
+#include "LoRaAnalogModel.h"
 #include "LoRaBandListening.h"
+#include "LoRaNeighborCache.h"
+#include "LoRaReceiver.h"
 #include "LoRaTransmission.h"
 #include "inet/common/INETUtils.h"
 #include "inet/common/ModuleAccess.h"
@@ -28,8 +31,10 @@
 #include "inet/physicallayer/wireless/common/medium/RadioMedium.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/SignalTag_m.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IErrorModel.h"
+#include "inet/physicallayer/wireless/common/radio/packetlevel/Interference.h"
 
 #include "../../helpers/DataLogger.h"
+#include "../../helpers/WorkerPool.h"
 
 namespace rlora {
 
@@ -42,6 +47,35 @@ LoRaMedium::LoRaMedium() :
 
 LoRaMedium::~LoRaMedium()
 {
+    delete workerPool;
+    // the signals themselves are owned by the medium
+    for (auto& it : signalBatches)
+        cancelAndDelete(it.second);
+}
+
+void LoRaMedium::initialize(int stage)
+{
+    RadioMedium::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        cullArrivals = par("cullArrivals");
+        cullingRange = m(par("cullingRange"));
+        partitionInterference = par("partitionInterference");
+        batchSignalArrivals = par("batchSignalArrivals");
+        snirIndications = par("snirIndications");
+        loRaNeighborCache = dynamic_cast<LoRaNeighborCache *>(neighborCache);
+    }
+    else if (stage == INITSTAGE_LAST) {
+        // the medium limit cache is complete once all radios registered
+        double bucketDuration = par("expiryBucketDuration");
+        expiryBucketDuration = std::isnan(bucketDuration) ? mediumLimitCache->getMaxTransmissionDuration() : SimTime(bucketDuration);
+        int numWorkerThreads = par("numWorkerThreads");
+        if (numWorkerThreads > 0) {
+            loRaAnalogModel = dynamic_cast<const LoRaAnalogModel *>(analogModel);
+            if (loRaAnalogModel == nullptr || loRaAnalogModel->getLoRaPathLoss() == nullptr || obstacleLoss != nullptr)
+                throw cRuntimeError("numWorkerThreads requires LoRaAnalogModel with LoRaLogNormalShadowing and no obstacle loss");
+            workerPool = new WorkerPool(numWorkerThreads);
+        }
+    }
 }
 
 void LoRaMedium::finish()
@@ -77,6 +111,9 @@ void LoRaMedium::finish()
     recordScalar("reception decision cache hit", decisionCacheHitPercentage, "%");
     recordScalar("reception result cache hit", resultCacheHitPercentage, "%");
 
+    string pathToCollisionPairs = par("pathToCollisionPairs");
+    if (!pathToCollisionPairs.empty())
+        DataLogger::getInstance()->writeCollisionPairsToFile(pathToCollisionPairs);
     string pathToCollisions = par("pathToCollisions");
     DataLogger::getInstance()->writeDataToFile(pathToCollisions);
 }
@@ -111,13 +148,13 @@ const IReceptionResult* LoRaMedium::getReceptionResult(const IRadio *radio, cons
         result = computeReceptionResult(radio, listening, transmission);
 
         auto pkt = const_cast<Packet*>(result->getPacket());
-        if (!pkt->findTag<SnirInd>()) {
+        if (snirIndications && !pkt->findTag<SnirInd>()) {
             const ISnir *snir = getSNIR(radio, transmission);
             auto snirInd = pkt->addTagIfAbsent<SnirInd>();
             snirInd->setMinimumSnir(snir->getMin());
             snirInd->setMaximumSnir(snir->getMax());
         }
-        if (!pkt->findTag<ErrorRateInd>()) {
+        if (snirIndications && !pkt->findTag<ErrorRateInd>()) {
             auto errorModel = dynamic_cast<IErrorModel*>(getSubmodule("errorModel"));
             const ISnir *snir = getSNIR(radio, transmission);
             auto errorRateInd = pkt->addTagIfAbsent<ErrorRateInd>(); // TODO: should be done  setPacketErrorRate(packetModel->getPER());
@@ -132,13 +169,276 @@ const IReceptionResult* LoRaMedium::getReceptionResult(const IRadio *radio, cons
     return result;
 }
 
+bool LoRaMedium::isSnirNeeded(const IRadio *receiver) const
+{
+    if (snirIndications)
+        return true;
+    auto loRaReceiver = dynamic_cast<const LoRaReceiver *>(receiver->getReceiver());
+    return loRaReceiver == nullptr || loRaReceiver->isSnirNeeded();
+}
+
+const IReceptionDecision *LoRaMedium::computeReceptionDecision(const IRadio *radio, const IListening *listening, const ITransmission *transmission, IRadioSignal::SignalPart part) const
+{
+    if (isSnirNeeded(radio))
+        return RadioMedium::computeReceptionDecision(radio, listening, transmission, part);
+    receptionDecisionComputationCount++;
+    const IReception *reception = getReception(radio, transmission);
+    const IInterference *interference = getInterference(radio, listening, transmission);
+    return radio->getReceiver()->computeReceptionDecision(listening, reception, part, interference, nullptr);
+}
+
+const IReceptionResult *LoRaMedium::computeReceptionResult(const IRadio *radio, const IListening *listening, const ITransmission *transmission) const
+{
+    if (isSnirNeeded(radio))
+        return RadioMedium::computeReceptionResult(radio, listening, transmission);
+    receptionResultComputationCount++;
+    const IReception *reception = getReception(radio, transmission);
+    const IInterference *interference = getInterference(radio, listening, transmission);
+    const std::vector<const IReceptionDecision *> *decisions = getReceptionDecisions(radio, listening, transmission);
+    return radio->getReceiver()->computeReceptionResult(listening, reception, interference, nullptr, decisions);
+}
+
+void LoRaMedium::sendToRadio(IRadio *transmitter, const IRadio *receiver, const IWirelessSignal *signal)
+{
+    // culled receivers have no arrival, they neither receive nor sense the signal
+    if (cullArrivals && communicationCache->getCachedArrival(receiver, signal->getTransmission()) == nullptr)
+        return;
+    if (batchSignalArrivals)
+        addToSignalBatch(transmitter, receiver, signal);
+    else
+        RadioMedium::sendToRadio(transmitter, receiver, signal);
+}
+
+void LoRaMedium::addToSignalBatch(IRadio *transmitter, const IRadio *receiver, const IWirelessSignal *transmittedSignal)
+{
+    // same checks as RadioMedium::sendToRadio, but the signal is queued instead of sent directly
+    const ITransmission *transmission = transmittedSignal->getTransmission();
+    if (receiver == transmitter || !isPotentialReceiver(receiver, transmission))
+        return;
+    Enter_Method_Silent();
+    const IArrival *arrival = getArrival(receiver, transmission);
+    simtime_t arrivalTime = simTime() + arrival->getStartPropagationTime();
+    auto receivedSignal = static_cast<WirelessSignal *>(createReceiverSignal(transmission));
+    SignalBatch *&batch = signalBatches[arrivalTime];
+    if (batch == nullptr) {
+        batch = new SignalBatch();
+        scheduleAt(arrivalTime, batch);
+    }
+    batch->signals.push_back(std::make_pair(check_and_cast<LoRaRadio *>(const_cast<IRadio *>(receiver)), receivedSignal));
+    communicationCache->setCachedSignal(receiver, transmission, receivedSignal);
+    signalSendCount++;
+}
+
+void LoRaMedium::deliverSignalBatch(SignalBatch *batch)
+{
+    signalBatches.erase(batch->getArrivalTime());
+    for (auto& it : batch->signals)
+        it.first->receiveBatchedSignal(it.second);
+    delete batch;
+}
+
+void LoRaMedium::removeFromSignalBatches(const IRadio *radio)
+{
+    // the batches keep raw receiver pointers, a removed radio must not be delivered to
+    for (auto it = signalBatches.begin(); it != signalBatches.end();) {
+        auto& signals = it->second->signals;
+        for (auto jt = signals.begin(); jt != signals.end();) {
+            if (jt->first == radio) {
+                delete jt->second;
+                jt = signals.erase(jt);
+            }
+            else
+                ++jt;
+        }
+        if (signals.empty()) {
+            cancelAndDelete(it->second);
+            it = signalBatches.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void LoRaMedium::removeRadio(const IRadio *radio)
+{
+    Enter_Method("removeRadio");
+    removeFromSignalBatches(radio);
+    RadioMedium::removeRadio(radio);
+}
+
+void LoRaMedium::handleMessage(cMessage *message)
+{
+    if (auto batch = dynamic_cast<SignalBatch *>(message))
+        deliverSignalBatch(batch);
+    else
+        RadioMedium::handleMessage(message);
+}
+
+m LoRaMedium::getCullingRange(const IRadio *transmitter) const
+{
+    if (!std::isnan(cullingRange.get()))
+        return cullingRange;
+    return mediumLimitCache->getMaxInterferenceRange(transmitter);
+}
+
+void LoRaMedium::mapRadiosInRange(const IRadio *transmitter, const ITransmission *transmission, m range, std::function<void (const IRadio *)> f) const
+{
+    const Coord& transmitterPosition = transmission->getStartPosition();
+    double sqrRange = range.get() * range.get();
+    auto filter = [&] (const IRadio *receiverRadio) {
+        if (receiverRadio != nullptr && receiverRadio->getAntenna()->getMobility()->getCurrentPosition().sqrdist(transmitterPosition) <= sqrRange)
+            f(receiverRadio);
+    };
+    // the neighbor lists are supersets of the radios within the neighbor cache range
+    const std::vector<const IRadio *> *neighbors = nullptr;
+    if (loRaNeighborCache != nullptr && loRaNeighborCache->getRange() >= range.get())
+        neighbors = loRaNeighborCache->getNeighbors(transmitter);
+    if (neighbors != nullptr) {
+        for (auto receiverRadio : *neighbors)
+            filter(receiverRadio);
+    }
+    else
+        communicationCache->mapRadios(filter);
+}
+
+void LoRaMedium::addInterferenceEntry(const ITransmission *transmission)
+{
+    const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
+    Hz carrierFrequency = loRaTransmission->getLoRaCF();
+    Hz bandwidth = loRaTransmission->getLoRaBW();
+    InterferencePartition& partition = interferencePartitions[carrierFrequency];
+    if (bandwidth > partition.bandwidth) {
+        // transmissions on other channels are never seen by the analog model, so reject overlapping bands here
+        for (const auto& it : interferencePartitions)
+            if (it.first != carrierFrequency && std::abs((it.first - carrierFrequency).get()) < ((bandwidth + it.second.bandwidth) / 2).get())
+                throw cRuntimeError("Overlapping bands are not supported");
+        partition.bandwidth = bandwidth;
+    }
+    partition.entries.push_back(InterferenceEntry{transmission, communicationCache->getCachedInterferenceEndTime(transmission)});
+}
+
+const std::deque<LoRaMedium::InterferenceEntry> *LoRaMedium::getInterferenceEntries(Hz carrierFrequency) const
+{
+    auto it = interferencePartitions.find(carrierFrequency);
+    return it != interferencePartitions.end() ? &it->second.entries : nullptr;
+}
+
+void LoRaMedium::addExpiryEntry(const ITransmission *transmission)
+{
+    // the bucket ending at or after the interference end time
+    int64_t bucket = (int64_t)ceil(communicationCache->getCachedInterferenceEndTime(transmission) / expiryBucketDuration);
+    if (expiryBuckets.empty())
+        firstExpiryBucket = bucket;
+    else if (bucket < firstExpiryBucket) {
+        expiryBuckets.insert(expiryBuckets.begin(), firstExpiryBucket - bucket, 0);
+        firstExpiryBucket = bucket;
+    }
+    if (bucket - firstExpiryBucket >= (int64_t)expiryBuckets.size())
+        expiryBuckets.resize(bucket - firstExpiryBucket + 1, 0);
+    expiryBuckets[bucket - firstExpiryBucket]++;
+    simtime_t bucketEndTime = expiryBucketDuration * (double)bucket;
+    if (!removeNonInterferingTransmissionsTimer->isScheduled() || bucketEndTime < removeNonInterferingTransmissionsTimer->getArrivalTime())
+        rescheduleAt(bucketEndTime, removeNonInterferingTransmissionsTimer);
+}
+
+void LoRaMedium::scheduleExpiryTimer()
+{
+    while (!expiryBuckets.empty() && expiryBuckets.front() == 0) {
+        expiryBuckets.pop_front();
+        firstExpiryBucket++;
+    }
+    if (!expiryBuckets.empty())
+        rescheduleAt(expiryBucketDuration * (double)firstExpiryBucket, removeNonInterferingTransmissionsTimer);
+}
+
+void LoRaMedium::removeNonInterferingTransmissions()
+{
+    simtime_t now = simTime();
+    if (expiryBucketDuration > 0) {
+        communicationCache->removeNonInterferingTransmissions([&] (const ITransmission *transmission) {
+            emit(signalRemovedSignal, check_and_cast<const cObject *>(transmission));
+        });
+        while (!expiryBuckets.empty() && expiryBucketDuration * (double)firstExpiryBucket <= now) {
+            expiryBuckets.pop_front();
+            firstExpiryBucket++;
+        }
+        scheduleExpiryTimer();
+    }
+    else
+        RadioMedium::removeNonInterferingTransmissions();
+    // expired entries behind a longer living one are skipped by the queries until they reach the front
+    for (auto& it : interferencePartitions) {
+        auto& entries = it.second.entries;
+        while (!entries.empty() && entries.front().interferenceEndTime <= now)
+            entries.pop_front();
+    }
+}
+
+const IInterference *LoRaMedium::computeInterference(const IRadio *receiver, const IListening *listening) const
+{
+    if (!partitionInterference)
+        return RadioMedium::computeInterference(receiver, listening);
+    interferenceComputationCount++;
+    const INoise *noise = backgroundNoise ? backgroundNoise->computeNoise(listening) : nullptr;
+    std::vector<const IReception *> *interferingReceptions = new std::vector<const IReception *>();
+    simtime_t now = simTime();
+    const LoRaBandListening *loRaListening = check_and_cast<const LoRaBandListening *>(listening);
+    if (auto entries = getInterferenceEntries(loRaListening->getLoRaCF())) {
+        for (const auto& entry : *entries) {
+            // expired transmissions may already be deleted, culled receivers have no arrival
+            if (entry.interferenceEndTime > now && communicationCache->getCachedArrival(receiver, entry.transmission) != nullptr && isInterferingTransmission(entry.transmission, listening))
+                interferingReceptions->push_back(getReception(receiver, entry.transmission));
+        }
+    }
+    return new Interference(noise, interferingReceptions);
+}
+
+const IInterference *LoRaMedium::computeInterference(const IRadio *receiver, const IListening *listening, const ITransmission *transmission) const
+{
+    if (!partitionInterference)
+        return RadioMedium::computeInterference(receiver, listening, transmission);
+    interferenceComputationCount++;
+    const IReception *reception = getReception(receiver, transmission);
+    const INoise *noise = backgroundNoise ? backgroundNoise->computeNoise(listening) : nullptr;
+    std::vector<const IReception *> *interferingReceptions = new std::vector<const IReception *>();
+    simtime_t now = simTime();
+    const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
+    if (auto entries = getInterferenceEntries(loRaTransmission->getLoRaCF())) {
+        for (const auto& entry : *entries) {
+            if (entry.interferenceEndTime > now && entry.transmission != transmission && communicationCache->getCachedArrival(receiver, entry.transmission) != nullptr && isInterferingTransmission(entry.transmission, reception))
+                interferingReceptions->push_back(getReception(receiver, entry.transmission));
+        }
+    }
+    return new Interference(noise, interferingReceptions);
+}
+
+void LoRaMedium::computeReceptionsInParallel(const ITransmission *transmission)
+{
+    const LoRaLogNormalShadowing *pathLoss = loRaAnalogModel->getLoRaPathLoss();
+    size_t count = pendingArrivals.size();
+    // drawn in receiver order, so the results don't depend on the number of threads
+    pendingShadowings.resize(count);
+    for (size_t i = 0; i < count; i++)
+        pendingShadowings[i] = pathLoss->computeShadowing(transmission->getTransmitterId(), transmission->getStartPosition(), pendingArrivals[i].first->getId(), pendingArrivals[i].second->getStartPosition());
+    pendingPowers.resize(count);
+    workerPool->parallelFor(count, [&] (size_t i) {
+        pendingPowers[i] = loRaAnalogModel->computeReceptionPower(pendingArrivals[i].first, transmission, pendingArrivals[i].second, pendingShadowings[i]);
+    });
+    for (size_t i = 0; i < count; i++) {
+        const IReception *reception = loRaAnalogModel->createReception(pendingArrivals[i].first, transmission, pendingArrivals[i].second, pendingPowers[i]);
+        communicationCache->setCachedReception(pendingArrivals[i].first, transmission, reception);
+        receptionComputationCount++;
+    }
+    pendingArrivals.clear();
+}
+
 void LoRaMedium::addTransmission(const IRadio *transmitterRadio, const ITransmission *transmission)
 {
     Enter_Method("addTransmission");
     transmissionCount++;
     communicationCache->addTransmission(transmission);
     simtime_t maxArrivalEndTime = transmission->getEndTime();
-    communicationCache->mapRadios([&](const IRadio *receiverRadio) {
+    auto addArrival = [&](const IRadio *receiverRadio) {
         if (receiverRadio != nullptr && receiverRadio != transmitterRadio && receiverRadio->getReceiver() != nullptr) {
             const IArrival *arrival = propagation->computeArrival(transmission, receiverRadio->getAntenna()->getMobility());
             const IntervalTree::Interval *interval = new IntervalTree::Interval(arrival->getStartTime(), arrival->getEndTime(), (void *)transmission);
@@ -150,10 +450,23 @@ void LoRaMedium::addTransmission(const IRadio *transmitterRadio, const ITransmis
             communicationCache->setCachedArrival(receiverRadio, transmission, arrival);
             communicationCache->setCachedInterval(receiverRadio, transmission, interval);
             communicationCache->setCachedListening(receiverRadio, transmission, loraListening);
+            if (workerPool != nullptr)
+                pendingArrivals.push_back(std::make_pair(receiverRadio, arrival));
         }
-    });
+    };
+    m range = cullArrivals ? getCullingRange(transmitterRadio) : m(NaN);
+    if (std::isfinite(range.get()))
+        mapRadiosInRange(transmitterRadio, transmission, range, addArrival);
+    else
+        communicationCache->mapRadios(addArrival);
+    if (workerPool != nullptr)
+        computeReceptionsInParallel(transmission);
     communicationCache->setCachedInterferenceEndTime(transmission, maxArrivalEndTime + mediumLimitCache->getMaxTransmissionDuration());
-    if (!removeNonInterferingTransmissionsTimer->isScheduled())
+    if (partitionInterference)
+        addInterferenceEntry(transmission);
+    if (expiryBucketDuration > 0)
+        addExpiryEntry(transmission);
+    else if (!removeNonInterferingTransmissionsTimer->isScheduled())
         scheduleAt(communicationCache->getCachedInterferenceEndTime(transmission), removeNonInterferingTransmissionsTimer);
     emit(signalAddedSignal, check_and_cast<const cObject*>(transmission));
 }
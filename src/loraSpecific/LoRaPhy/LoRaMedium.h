@@ -29,23 +29,117 @@
 #include "inet/physicallayer/wireless/common/contract/packetlevel/INeighborCache.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
 #include <algorithm>
+#include <deque>
 
 namespace rlora {
+
+class LoRaNeighborCache;
+class LoRaAnalogModel;
+class WorkerPool;
+
 class LoRaMedium : public RadioMedium
 {
     friend class LoRaGWRadio;
     friend class LoRaRadio;
 
 protected:
+    /**
+     * When enabled, arrivals, intervals and listenings are only created for the
+     * receivers within cullingRange of the transmitter.
+     */
+    bool cullArrivals = false;
+    m cullingRange = m(NaN);
+    const LoRaNeighborCache *loRaNeighborCache = nullptr;
+
+    /**
+     * Interference candidates partitioned by carrier frequency, interference
+     * queries only visit the transmissions on the channel of the listening.
+     * The interference end time is stored with the transmission, so expired
+     * entries can be skipped without touching the already deleted transmission.
+     * Entries are appended in transmission order and dropped from the front.
+     */
+    struct InterferenceEntry
+    {
+        const ITransmission *transmission;
+        simtime_t interferenceEndTime;
+    };
+    struct InterferencePartition
+    {
+        Hz bandwidth = Hz(0); // widest bandwidth used on the channel
+        std::deque<InterferenceEntry> entries;
+    };
+    bool partitionInterference = true;
+    std::map<Hz, InterferencePartition> interferencePartitions;
+
+    /**
+     * Timing wheel for removing the non interfering transmissions. Every bucket
+     * counts the transmissions whose interference ends within it, the removal
+     * timer only fires at the end of non empty buckets.
+     */
+    simtime_t expiryBucketDuration;
+    int64_t firstExpiryBucket = 0;
+    std::deque<int> expiryBuckets;
+
+    /**
+     * With worker threads the receptions of a new transmission are computed at
+     * once in addTransmission. Random numbers are drawn on the simulation thread,
+     * only the deterministic power computation is spread over the workers.
+     */
+    WorkerPool *workerPool = nullptr;
+    const LoRaAnalogModel *loRaAnalogModel = nullptr;
+    std::vector<std::pair<const IRadio *, const IArrival *>> pendingArrivals;
+    std::vector<double> pendingShadowings;
+    std::vector<W> pendingPowers;
+
+    /**
+     * With batchSignalArrivals the receiver signals with the same arrival time
+     * are delivered by one self message instead of one message per receiver.
+     */
+    class SignalBatch : public cMessage
+    {
+      public:
+        std::vector<std::pair<LoRaRadio *, WirelessSignal *>> signals;
+        SignalBatch() : cMessage("signalBatch") {}
+    };
+    bool batchSignalArrivals = false;
+    std::map<simtime_t, SignalBatch *> signalBatches;
+
+    /**
+     * The SNIR is only computed for the SnirInd and ErrorRateInd tags if enabled,
+     * or if the receiver needs it for its decisions (error model).
+     */
+    bool snirIndications = false;
+
+protected:
+    virtual void initialize(int stage) override;
     virtual bool matchesMacAddressFilter(const IRadio *radio, const Packet *packet) const override;
+    virtual m getCullingRange(const IRadio *transmitter) const;
+    virtual void mapRadiosInRange(const IRadio *transmitter, const ITransmission *transmission, m range, std::function<void (const IRadio *)> f) const;
+    virtual void addInterferenceEntry(const ITransmission *transmission);
+    virtual const std::deque<InterferenceEntry> *getInterferenceEntries(Hz carrierFrequency) const;
+    virtual void addExpiryEntry(const ITransmission *transmission);
+    virtual void scheduleExpiryTimer();
+    virtual void removeNonInterferingTransmissions() override;
+    virtual void computeReceptionsInParallel(const ITransmission *transmission);
+    virtual void handleMessage(cMessage *message) override;
+    virtual void addToSignalBatch(IRadio *transmitter, const IRadio *receiver, const IWirelessSignal *signal);
+    virtual void deliverSignalBatch(SignalBatch *batch);
+    virtual void removeFromSignalBatches(const IRadio *radio);
+    virtual bool isSnirNeeded(const IRadio *receiver) const;
+    virtual const IReceptionDecision *computeReceptionDecision(const IRadio *receiver, const IListening *listening, const ITransmission *transmission, IRadioSignal::SignalPart part) const override;
+    virtual const IReceptionResult *computeReceptionResult(const IRadio *receiver, const IListening *listening, const ITransmission *transmission) const override;
+    virtual const IInterference *computeInterference(const IRadio *receiver, const IListening *listening) const override;
+    virtual const IInterference *computeInterference(const IRadio *receiver, const IListening *listening, const ITransmission *transmission) const override;
         //@}
     public:
       LoRaMedium();
       virtual void finish() override;
+      virtual void sendToRadio(IRadio *transmitter, const IRadio *receiver, const IWirelessSignal *signal) override;
       virtual ~LoRaMedium();
       //virtual const IReceptionDecision *getReceptionDecision(const IRadio *receiver, const IListening *listening, const ITransmission *transmission, IRadioSignal::SignalPart part) const override;
       virtual const IReceptionResult *getReceptionResult(const IRadio *receiver, const IListening *listening, const ITransmission *transmission) const override;
       virtual void addTransmission(const IRadio *transmitter, const ITransmission *transmission);
+      virtual void removeRadio(const IRadio *radio) override;
 };
 }
 #endif /* LORAPHY_LORAMEDIUM_H_ */
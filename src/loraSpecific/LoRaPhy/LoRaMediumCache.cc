@@ -18,7 +18,6 @@
 #include <algorithm>
 #include "../LoRaPhy/LoRaMediumCache.h"
 #include "../LoRaPhy/LoRaMedium.h"
-#include "../LoRaPhy/LoRaLogNormalShadowing.h"
 
 namespace rlora {
 
@@ -62,6 +61,7 @@ inline double maxIgnoreNaN(double a, double b)
 
 LoRaMediumCache::LoRaMediumCache() :
     radioMedium(nullptr),
+    loRaPathLoss(nullptr),
     minConstraintArea(Coord::NIL),
     maxConstraintArea(Coord::NIL),
     maxSpeed(mps(NaN)),
@@ -80,6 +80,7 @@ void LoRaMediumCache::initialize(int stage)
 {
     if (stage == INITSTAGE_LOCAL) {
         radioMedium = check_and_cast<LoRaMedium *>(getParentModule());
+        loRaPathLoss = dynamic_cast<LoRaLogNormalShadowing *>(radioMedium->getSubmodule("pathLoss"));
         WATCH(minConstraintArea);
         WATCH(maxConstraintArea);
         WATCH(maxSpeed);
@@ -127,16 +128,72 @@ void LoRaMediumCache::updateLimits()
     maxInterferenceRange = computeMaxInterferenceRange();
 }
 
+void LoRaMediumCache::updateLimits(const IRadio *radio)
+{
+    if (radio == nullptr)
+        return;
+    const IMobility *mobility = radio->getAntenna()->getMobility();
+    minConstraintArea = minConstraintArea.min(mobility->getConstraintAreaMin());
+    maxConstraintArea = maxConstraintArea.max(mobility->getConstraintAreaMax());
+    maxSpeed = maxIgnoreNaN(maxSpeed, mps(mobility->getMaxSpeed()));
+    W oldMaxTransmissionPower = maxTransmissionPower;
+    W oldMinInterferencePower = minInterferencePower;
+    double oldMaxAntennaGain = maxAntennaGain;
+    maxTransmissionPower = maxIgnoreNaN(maxTransmissionPower, radio->getTransmitter()->getMaxPower());
+    minInterferencePower = minIgnoreNaN(minInterferencePower, radio->getReceiver()->getMinInterferencePower());
+    minReceptionPower = minIgnoreNaN(minReceptionPower, radio->getReceiver()->getMinReceptionPower());
+    maxAntennaGain = maxIgnoreNaN(maxAntennaGain, radio->getAntenna()->getGain()->getMaxGain());
+    // NaN never compares equal, so a NaN limit is recomputed too
+    if (!(maxTransmissionPower == oldMaxTransmissionPower && minInterferencePower == oldMinInterferencePower && maxAntennaGain == oldMaxAntennaGain))
+        maxInterferenceRange = computeMaxInterferenceRange();
+}
+
+void LoRaMediumCache::updateLimitsAfterRemoval(const IRadio *radio)
+{
+    if (radio == nullptr)
+        return;
+    const IMobility *mobility = radio->getAntenna()->getMobility();
+    Coord constraintAreaMin = mobility->getConstraintAreaMin();
+    Coord constraintAreaMax = mobility->getConstraintAreaMax();
+    if (constraintAreaMin.x == minConstraintArea.x || constraintAreaMin.y == minConstraintArea.y || constraintAreaMin.z == minConstraintArea.z)
+        minConstraintArea = computeMinConstraintArea();
+    if (constraintAreaMax.x == maxConstraintArea.x || constraintAreaMax.y == maxConstraintArea.y || constraintAreaMax.z == maxConstraintArea.z)
+        maxConstraintArea = computeMaxConstreaintArea();
+    if (mps(mobility->getMaxSpeed()) == maxSpeed)
+        maxSpeed = computeMaxSpeed();
+    bool rangeChanged = false;
+    if (radio->getTransmitter()->getMaxPower() == maxTransmissionPower) {
+        maxTransmissionPower = computeMaxTransmissionPower();
+        rangeChanged = true;
+    }
+    if (radio->getReceiver()->getMinInterferencePower() == minInterferencePower) {
+        minInterferencePower = computeMinInterferencePower();
+        rangeChanged = true;
+    }
+    if (radio->getReceiver()->getMinReceptionPower() == minReceptionPower)
+        minReceptionPower = computeMinReceptionPower();
+    if (radio->getAntenna()->getGain()->getMaxGain() == maxAntennaGain) {
+        maxAntennaGain = computeMaxAntennaGain();
+        rangeChanged = true;
+    }
+    if (rangeChanged)
+        maxInterferenceRange = computeMaxInterferenceRange();
+}
+
 void LoRaMediumCache::addRadio(const IRadio *radio)
 {
     radios.push_back(radio);
-    updateLimits();
+    // the first radio also picks up the limits given as parameters
+    if (radios.size() == 1)
+        updateLimits();
+    else
+        updateLimits(radio);
 }
 
 void LoRaMediumCache::removeRadio(const IRadio *radio)
 {
     radios.erase(std::remove(radios.begin(), radios.end(), radio), radios.end());
-    updateLimits();
+    updateLimitsAfterRemoval(radio);
 }
 
 mps LoRaMediumCache::computeMaxSpeed() const
@@ -246,11 +303,8 @@ m LoRaMediumCache::getMaxInterferenceRange(const IRadio* radio) const
 
 m LoRaMediumCache::getMaxCommunicationRange(const IRadio* radio) const
 {
-    if (strcmp(radioMedium->par("pathLossType").stringValue(), "LoRaLogNormalShadowing") == 0) {
-        LoRaLogNormalShadowing *loraLogNormalShadowing;
-        loraLogNormalShadowing = check_and_cast<LoRaLogNormalShadowing *>(radioMedium->getSubmodule("pathLoss"));
-        return(loraLogNormalShadowing->computeRange(maxTransmissionPower));
-    }
+    if (loRaPathLoss != nullptr)
+        return loRaPathLoss->computeRange(maxTransmissionPower);
     throw cRuntimeError("Unknown pathLossType. Only LoRaLogNormalShadowing is supported by the LoRaMediumCache.");
 }
 
@@ -21,6 +21,7 @@
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IMediumLimitCache.h"
 #include "../LoRaPhy/LoRaMedium.h"
+#include "../LoRaPhy/LoRaLogNormalShadowing.h"
 
 namespace rlora {
 
@@ -32,6 +33,12 @@ class LoRaMediumCache : public cModule, public IMediumLimitCache
      */
     const LoRaMedium *radioMedium;
 
+    /**
+     * The path loss model of the medium, resolved once at initialization,
+     * nullptr if it isn't LoRaLogNormalShadowing.
+     */
+    const LoRaLogNormalShadowing *loRaPathLoss;
+
     /**
      * The list of communicating radios on the medium.
      */
@@ -121,6 +128,14 @@ class LoRaMediumCache : public cModule, public IMediumLimitCache
     virtual m computeMaxInterferenceRange() const;
 
     virtual void updateLimits();
+    /**
+     * Folds the limits of a new radio into the current ones.
+     */
+    virtual void updateLimits(const IRadio *addedRadio);
+    /**
+     * Recomputes only the limits where the removed radio was the extremum.
+     */
+    virtual void updateLimitsAfterRemoval(const IRadio *removedRadio);
     //@}
 
   public:
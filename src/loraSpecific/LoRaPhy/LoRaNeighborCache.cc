@@ -17,6 +17,7 @@
 
 #include "../LoRaPhy/LoRaNeighborCache.h"
 #include "inet/common/ModuleAccess.h"
+#include <algorithm>
 
 namespace rlora {
 
@@ -27,7 +28,12 @@ LoRaNeighborCache::LoRaNeighborCache() :
     updateNeighborListsTimer(nullptr),
     refillPeriod(NaN),
     range(NaN),
-    maxSpeed(NaN)
+    maxSpeed(NaN),
+    verletList(false),
+    skin(NaN),
+    neighborSearch(NEIGHBOR_SEARCH_BRUTE_FORCE),
+    gridCellSize(NaN),
+    deferNeighborLists(false)
 {
 }
 
@@ -37,10 +43,22 @@ void LoRaNeighborCache::initialize(int stage)
         radioMedium = getModuleFromPar<LoRaMedium>(par("radioMediumModule"), this);
         refillPeriod = par("refillPeriod");
         range = par("range");
+        const char *neighborSearchString = par("neighborSearch");
+        if (!strcmp(neighborSearchString, "bruteForce"))
+            neighborSearch = NEIGHBOR_SEARCH_BRUTE_FORCE;
+        else if (!strcmp(neighborSearchString, "grid"))
+            neighborSearch = NEIGHBOR_SEARCH_GRID;
+        else
+            throw cRuntimeError("Unknown neighborSearch: '%s'", neighborSearchString);
+        verletList = par("verletList");
+        skin = par("skin");
+        deferNeighborLists = par("bulkRegistration");
         updateNeighborListsTimer = new cMessage("updateNeighborListsTimer");
     }
     else if (stage == INITSTAGE_PHYSICAL_LAYER_NEIGHBOR_CACHE) {
         maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
+        // builds the lists of all radios registered so far in one pass
+        deferNeighborLists = false;
         updateNeighborLists();
         if (maxSpeed != 0)
             scheduleAt(simTime() + refillPeriod, updateNeighborListsTimer);
@@ -53,7 +71,10 @@ std::ostream& LoRaNeighborCache::printToStream(std::ostream& stream, int level,
     if (level <= PRINT_LEVEL_TRACE)
         stream << ", refillPeriod = " << refillPeriod
                << ", range = " << range
-               << ", maxSpeed = " << maxSpeed;
+               << ", maxSpeed = " << maxSpeed
+               << ", verletList = " << verletList
+               << ", skin = " << getSkin()
+               << ", neighborSearch = " << (neighborSearch == NEIGHBOR_SEARCH_GRID ? "grid" : "bruteForce");
     return stream;
 }
 
@@ -74,32 +95,88 @@ void LoRaNeighborCache::sendToNeighbors(IRadio *transmitter, const IWirelessSign
         radioMedium->sendToRadio(transmitter, elem, frame);
 }
 
+const LoRaNeighborCache::Radios *LoRaNeighborCache::getNeighbors(const IRadio *radio) const
+{
+    auto it = radioToEntry.find(radio);
+    return it != radioToEntry.end() ? &it->second->neighborVector : nullptr;
+}
+
 void LoRaNeighborCache::handleMessage(cMessage *msg)
 {
     if (!msg->isSelfMessage())
         throw cRuntimeError("This module only handles self messages");
 
-    updateNeighborLists();
+    if (verletList)
+        updateStaleNeighborLists();
+    else
+        updateNeighborLists();
 
     scheduleAt(simTime() + refillPeriod, msg);
 }
 
 void LoRaNeighborCache::updateNeighborList(RadioEntry *radioEntry)
 {
-    IMobility *radioMobility = radioEntry->radio->getAntenna()->getMobility();
-    Coord radioPosition = radioMobility->getCurrentPosition();
-    double radius = maxSpeed * refillPeriod + range;
+    double radius = getNeighborRadius();
     radioEntry->neighborVector.clear();
 
-    for (auto & elem : radios) {
-        const IRadio *otherRadio = elem->radio;
-        Coord otherEntryPosition = otherRadio->getAntenna()->getMobility()->getCurrentPosition();
+    if (neighborSearch == NEIGHBOR_SEARCH_GRID && gridCellSize > 0) {
+        // the cell size equals the radius, so every neighbor lies in one of the adjacent cells
+        GridCell cell = getGridCell(radioEntry->position);
+        for (int dx = -1; dx <= 1; dx++)
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dz = -1; dz <= 1; dz++) {
+                    auto it = grid.find({cell.x + dx, cell.y + dy, cell.z + dz});
+                    if (it != grid.end())
+                        for (auto & elem : it->second)
+                            addNeighborIfInRange(radioEntry, elem, radius);
+                }
+    }
+    else {
+        for (auto & elem : radios)
+            addNeighborIfInRange(radioEntry, elem, radius);
+    }
+    // the grid and the incremental Verlet updates rely on lists ordered by radio id
+    if (neighborSearch == NEIGHBOR_SEARCH_GRID || verletList)
+        std::sort(radioEntry->neighborVector.begin(), radioEntry->neighborVector.end(), compareRadioIds);
+}
+
+void LoRaNeighborCache::addNeighborIfInRange(RadioEntry *radioEntry, const RadioEntry *otherEntry, double radius) const
+{
+    const IRadio *otherRadio = otherEntry->radio;
+    if (otherRadio->getId() != radioEntry->radio->getId() &&
+        otherEntry->position.sqrdist(radioEntry->position) <= radius * radius)
+        radioEntry->neighborVector.push_back(otherRadio);
+}
+
+void LoRaNeighborCache::fillGrid()
+{
+    gridCellSize = getNeighborRadius();
+    // keep the buckets allocated, cells are revisited on every refill
+    for (auto & cell : grid)
+        cell.second.clear();
+    if (!(gridCellSize > 0))
+        return;
+    for (auto & elem : radios)
+        grid[getGridCell(elem->position)].push_back(elem);
+}
 
-        if (otherRadio->getId() != radioEntry->radio->getId() &&
-            otherEntryPosition.sqrdist(radioPosition) <= radius * radius)
-            radioEntry->neighborVector.push_back(otherRadio);
+void LoRaNeighborCache::moveGridEntry(RadioEntry *radioEntry, const Coord& newPosition)
+{
+    if (gridCellSize > 0) {
+        GridCell oldCell = getGridCell(radioEntry->position);
+        GridCell newCell = getGridCell(newPosition);
+        if (!(oldCell == newCell)) {
+            RadioEntries& oldEntries = grid[oldCell];
+            oldEntries.erase(std::find(oldEntries.begin(), oldEntries.end(), radioEntry));
+            grid[newCell].push_back(radioEntry);
+        }
     }
+    radioEntry->position = newPosition;
+}
 
+LoRaNeighborCache::GridCell LoRaNeighborCache::getGridCell(const Coord& position) const
+{
+    return {(int)std::floor(position.x / gridCellSize), (int)std::floor(position.y / gridCellSize), (int)std::floor(position.z / gridCellSize)};
 }
 
 void LoRaNeighborCache::addRadio(const IRadio *radio)
@@ -107,7 +184,8 @@ void LoRaNeighborCache::addRadio(const IRadio *radio)
     RadioEntry *newEntry = new RadioEntry(radio);
     radios.push_back(newEntry);
     radioToEntry[radio] = newEntry;
-    updateNeighborLists();
+    if (!deferNeighborLists)
+        updateNeighborLists();
     maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
     if (maxSpeed != 0 && !updateNeighborListsTimer->isScheduled() && initialized())
         scheduleAt(simTime() + refillPeriod, updateNeighborListsTimer);
@@ -118,6 +196,12 @@ void LoRaNeighborCache::removeRadio(const IRadio *radio)
     auto it = find(radios.begin(), radios.end(), radioToEntry[radio]);
     if (it != radios.end()) {
         removeRadioFromNeighborLists(radio);
+        if (neighborSearch == NEIGHBOR_SEARCH_GRID && gridCellSize > 0) {
+            RadioEntries& cellEntries = grid[getGridCell((*it)->position)];
+            auto jt = std::find(cellEntries.begin(), cellEntries.end(), *it);
+            if (jt != cellEntries.end())
+                cellEntries.erase(jt);
+        }
         radios.erase(it);
         maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
         if (maxSpeed == 0 && initialized())
@@ -132,13 +216,87 @@ void LoRaNeighborCache::updateNeighborLists()
 {
     EV_DETAIL << "Updating the neighbor lists" << endl;
     for (auto & elem : radios)
+        elem->position = elem->radio->getAntenna()->getMobility()->getCurrentPosition();
+    if (neighborSearch == NEIGHBOR_SEARCH_GRID)
+        fillGrid();
+    for (auto & elem : radios)
+        updateNeighborList(elem);
+}
+
+void LoRaNeighborCache::updateStaleNeighborLists()
+{
+    // Every pair is evaluated with the positions of the last rebuilds (range + skin). A radio
+    // is refreshed before it can drift more than half of the skin away from that position,
+    // thus no pair can get closer than range unnoticed. The check itself runs only once per
+    // refillPeriod, hence the margin for the movement until the next check.
+    double maxDisplacement = getSkin() / 2 - maxSpeed * refillPeriod;
+    staleEntries.clear();
+    for (auto & elem : radios) {
+        Coord position = elem->radio->getAntenna()->getMobility()->getCurrentPosition();
+        if (!(position.distance(elem->position) <= maxDisplacement))
+            staleEntries.push_back(elem);
+    }
+    EV_DETAIL << "Updating " << staleEntries.size() << " of " << radios.size() << " neighbor lists" << endl;
+    if (staleEntries.size() == radios.size()) {
+        updateNeighborLists();
+        return;
+    }
+    for (auto & elem : staleEntries)
+        moveGridEntry(elem, elem->radio->getAntenna()->getMobility()->getCurrentPosition());
+    for (auto & elem : staleEntries) {
+        oldNeighbors.swap(elem->neighborVector);
         updateNeighborList(elem);
+        // neighborship is symmetric, so the lists of the old and new neighbors are patched too
+        const Radios& newNeighbors = elem->neighborVector;
+        auto oldIt = oldNeighbors.begin();
+        auto newIt = newNeighbors.begin();
+        while (oldIt != oldNeighbors.end() || newIt != newNeighbors.end()) {
+            if (newIt == newNeighbors.end() || (oldIt != oldNeighbors.end() && compareRadioIds(*oldIt, *newIt))) {
+                removeNeighbor(radioToEntry[*oldIt], elem->radio);
+                oldIt++;
+            }
+            else if (oldIt == oldNeighbors.end() || compareRadioIds(*newIt, *oldIt)) {
+                insertNeighbor(radioToEntry[*newIt], elem->radio);
+                newIt++;
+            }
+            else {
+                oldIt++;
+                newIt++;
+            }
+        }
+    }
+}
+
+void LoRaNeighborCache::insertNeighbor(RadioEntry *radioEntry, const IRadio *neighbor)
+{
+    Radios& neighborVector = radioEntry->neighborVector;
+    auto it = std::lower_bound(neighborVector.begin(), neighborVector.end(), neighbor, compareRadioIds);
+    if (it == neighborVector.end() || *it != neighbor)
+        neighborVector.insert(it, neighbor);
+}
+
+void LoRaNeighborCache::removeNeighbor(RadioEntry *radioEntry, const IRadio *neighbor)
+{
+    Radios& neighborVector = radioEntry->neighborVector;
+    auto it = std::lower_bound(neighborVector.begin(), neighborVector.end(), neighbor, compareRadioIds);
+    if (it != neighborVector.end() && *it == neighbor)
+        neighborVector.erase(it);
+}
+
+double LoRaNeighborCache::getSkin() const
+{
+    return std::isnan(skin) ? 4 * maxSpeed * refillPeriod : skin;
+}
+
+double LoRaNeighborCache::getNeighborRadius() const
+{
+    return verletList ? range + getSkin() : maxSpeed * refillPeriod + range;
 }
 
 void LoRaNeighborCache::removeRadioFromNeighborLists(const IRadio *radio)
 {
     for (auto & elem : radios) {
-        Radios neighborVector = elem->neighborVector;
+        Radios& neighborVector = elem->neighborVector;
         auto it = find(neighborVector.begin(), neighborVector.end(), radio);
         if (it != neighborVector.end())
             neighborVector.erase(it);
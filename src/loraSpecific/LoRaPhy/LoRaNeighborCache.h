@@ -20,6 +20,7 @@
 #include "inet/physicallayer/wireless/common/medium/RadioMedium.h"
 #include "../LoRaPhy/LoRaMedium.h"
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace rlora {
@@ -31,6 +32,7 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     {
         RadioEntry(const IRadio *radio) : radio(radio) {};
         const IRadio *radio;
+        Coord position;
         std::vector<const IRadio *> neighborVector;
         bool operator==(RadioEntry *rhs) const
         {
@@ -41,6 +43,30 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     typedef std::vector<const IRadio *> Radios;
     typedef std::map<const IRadio *, RadioEntry *> RadioEntryCache;
 
+    enum NeighborSearch {
+        NEIGHBOR_SEARCH_BRUTE_FORCE,
+        NEIGHBOR_SEARCH_GRID,
+    };
+
+    struct GridCell
+    {
+        int x;
+        int y;
+        int z;
+        bool operator==(const GridCell& rhs) const
+        {
+            return x == rhs.x && y == rhs.y && z == rhs.z;
+        }
+    };
+    struct GridCellHash
+    {
+        size_t operator()(const GridCell& cell) const
+        {
+            return std::hash<int64_t>()(((int64_t)cell.x * 73856093) ^ ((int64_t)cell.y * 19349663) ^ ((int64_t)cell.z * 83492791));
+        }
+    };
+    typedef std::unordered_map<GridCell, RadioEntries, GridCellHash> Grid;
+
   protected:
     LoRaMedium *radioMedium;
     RadioEntries radios;
@@ -49,6 +75,16 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     double refillPeriod;
     double range;
     double maxSpeed;
+    bool verletList;
+    double skin;
+    RadioEntries staleEntries;
+    Radios oldNeighbors;
+    NeighborSearch neighborSearch;
+    /** @brief Radios bucketed by position, the cell size is the neighbor radius. */
+    Grid grid;
+    double gridCellSize;
+    /** @brief Radios registering before the neighbor cache init stage are only collected, the lists are built once. */
+    bool deferNeighborLists;
 
   protected:
     virtual int numInitStages() const override { return NUM_INIT_STAGES; }
@@ -56,8 +92,19 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     virtual void handleMessage(cMessage *msg) override;
     void updateNeighborList(RadioEntry *radioEntry);
     void updateNeighborLists();
+    void updateStaleNeighborLists();
+    void insertNeighbor(RadioEntry *radioEntry, const IRadio *neighbor);
+    void removeNeighbor(RadioEntry *radioEntry, const IRadio *neighbor);
+    double getSkin() const;
+    double getNeighborRadius() const;
+    void fillGrid();
+    void moveGridEntry(RadioEntry *radioEntry, const Coord& newPosition);
+    GridCell getGridCell(const Coord& position) const;
+    void addNeighborIfInRange(RadioEntry *radioEntry, const RadioEntry *otherEntry, double radius) const;
     void removeRadioFromNeighborLists(const IRadio *radio);
 
+    static bool compareRadioIds(const IRadio *a, const IRadio *b) { return a->getId() < b->getId(); }
+
   public:
     LoRaNeighborCache();
     ~LoRaNeighborCache();
@@ -66,6 +113,9 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     virtual void addRadio(const IRadio *radio) override;
     virtual void removeRadio(const IRadio *radio) override;
     virtual void sendToNeighbors(IRadio *transmitter, const IWirelessSignal *frame, double range) const override;
+
+    double getRange() const { return range; }
+    const Radios *getNeighbors(const IRadio *radio) const;
 };
 
 } // namespace inet
@@ -0,0 +1,109 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAOBJECTPOOL_H_
+#define LORAPHY_LORAOBJECTPOOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace rlora {
+
+/**
+ * Slab allocator for the objects the medium creates per (transmission, receiver)
+ * pair. Memory is taken from slabs of SLAB_SIZE objects and returned to a free
+ * list on deletion, so when the communication cache drops an expired
+ * transmission its objects are recycled for the next one instead of going back
+ * to malloc. Slabs are never released. Not thread-safe.
+ */
+template<typename T>
+class LoRaObjectPool
+{
+  protected:
+    union Slot
+    {
+        Slot *next;
+        alignas(T) char storage[sizeof(T)];
+    };
+    static const size_t SLAB_SIZE = 1024;
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot *freeList = nullptr;
+
+  protected:
+    static LoRaObjectPool& getInstance()
+    {
+        static LoRaObjectPool pool;
+        return pool;
+    }
+
+    void grow()
+    {
+        Slot *slab = new Slot[SLAB_SIZE];
+        slabs.emplace_back(slab);
+        for (size_t i = 0; i < SLAB_SIZE; i++) {
+            slab[i].next = freeList;
+            freeList = &slab[i];
+        }
+    }
+
+  public:
+    static void *allocate(size_t size)
+    {
+        // objects of derived classes don't fit into the slots
+        if (size != sizeof(T))
+            return ::operator new(size);
+        LoRaObjectPool& pool = getInstance();
+        if (pool.freeList == nullptr)
+            pool.grow();
+        Slot *slot = pool.freeList;
+        pool.freeList = slot->next;
+        return slot;
+    }
+
+    static void deallocate(void *object, size_t size)
+    {
+        if (object == nullptr)
+            return;
+        if (size != sizeof(T)) {
+            ::operator delete(object);
+            return;
+        }
+        LoRaObjectPool& pool = getInstance();
+        Slot *slot = static_cast<Slot *>(object);
+        slot->next = pool.freeList;
+        pool.freeList = slot;
+    }
+};
+
+/**
+ * Pooled variant of a class with a virtual destructor, the objects can be
+ * deleted through base class pointers as usual (e.g. by the communication cache).
+ */
+template<typename T>
+class LoRaPooled : public T
+{
+  public:
+    using T::T;
+
+    static void *operator new(size_t size) { return LoRaObjectPool<LoRaPooled<T>>::allocate(size); }
+    static void operator delete(void *object, size_t size) { LoRaObjectPool<LoRaPooled<T>>::deallocate(object, size); }
+};
+
+} // namespace rlora
+
+#endif /* LORAPHY_LORAOBJECTPOOL_H_ */
@@ -17,10 +17,14 @@
 
 #include "../../helpers/DataLogger.h"
 #include "LoRaReception.h"
+#include "LoRaAnalogModel.h"
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarNoise.h"
 #include "LoRaPhyPreamble_m.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/SignalTag_m.h"
 #include "../../common/tags/MessageInfoTag_m.h"
+#include "LoRaObjectPool.h"
+#include "LoRaSensitivityTable.h"
+#include "LoRaTimeOnAir.h"
 
 namespace rlora {
 
@@ -103,91 +107,63 @@ bool LoRaReceiver::computeIsReceptionAttempted(const IListening *listening, cons
 
 bool LoRaReceiver::isPacketCollided(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
 {
-    //auto radio = reception->getReceiver();
-    //auto radioMedium = radio->getMedium();
     auto interferingReceptions = interference->getInterferingReceptions();
     const LoRaReception *loRaReception = check_and_cast<const LoRaReception*>(reception);
-    simtime_t m_x = (loRaReception->getStartTime() + loRaReception->getEndTime()) / 2;
-    simtime_t d_x = (loRaReception->getEndTime() - loRaReception->getStartTime()) / 2;
+    const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission*>(reception->getTransmission());
     EV << "The transmission duration is: " << loRaReception->getEndTime() - loRaReception->getStartTime() << endl;
-    double P_threshold = 6;
-    W signalRSSI_w = loRaReception->getPower();
-    double signalRSSI_mw = signalRSSI_w.get() * 1000;
-    double signalRSSI_dBm = math::mW2dBmW(signalRSSI_mw);
-    EV << "Signal RSSI in dBm: " << signalRSSI_dBm << endl;
-    int receptionSF = loRaReception->getLoRaSF();
 
-    bool isCollided = false;
+    InterfererBatch& batch = interfererBatch;
+    batch.clear();
     for (auto interferingReception : *interferingReceptions) {
-        int id1 = reception->getTransmission()->getId();
-        int id2 = interferingReception->getTransmission()->getId();
-
-        auto messageInfoTag1 = reception->getTransmission()->getPacket()->getTag<MessageInfoTag>();
-        auto messageInfoTag2 = interferingReception->getTransmission()->getPacket()->getTag<MessageInfoTag>();
-
-        if (messageInfoTag1->getHasUsefulData() || messageInfoTag2->getHasUsefulData()) {
-            DataLogger::getInstance()->logPossibleCollision(id1, id2);
-        }
-
-        bool overlap = false;
-        bool frequencyCollision = false;
-        bool captureEffect = false;
-        bool timingCollision = false; //Collision is acceptable in first part of preamble
         const LoRaReception *loRaInterference = check_and_cast<const LoRaReception*>(interferingReception);
+        batch.receptions.push_back(loRaInterference);
+        batch.startTimes.push_back(loRaInterference->getStartTime().raw());
+        batch.endTimes.push_back(loRaInterference->getEndTime().raw());
+        batch.powers.push_back(loRaInterference->getPower().get());
+        batch.centerFrequencies.push_back(loRaInterference->getLoRaCF().get());
+        batch.usefulData.push_back(check_and_cast<const LoRaTransmission*>(loRaInterference->getTransmission())->hasUsefulData());
+    }
+    size_t numInterferers = batch.receptions.size();
+    batch.collided.resize(numInterferers);
+
+    // the times are compared as raw simtime values, the same integer arithmetic as with simtime_t
+    int64_t m_x = (loRaReception->getStartTime().raw() + loRaReception->getEndTime().raw()) / 2;
+    int64_t d_x = (loRaReception->getEndTime().raw() - loRaReception->getStartTime().raw()) / 2;
+    double centerFrequency = loRaReception->getLoRaCF().get();
+    double signalPower = loRaReception->getPower().get();
+    /* If difference in power between two signals is at least 12 dB, no collision*/
+    const double captureRatio = math::dB2fraction(12);
+    /* If last 6 symbols of preamble are received, no collision*/
+    double nPreamble = 8; //from the paper "Do Lora networks..."
+    simtime_t Tsym = LoRaTimeOnAir::getSymbolDuration(loRaReception->getLoRaSF(), loRaReception->getLoRaBW());
+    int64_t csBegin = (loRaReception->getPreambleStartTime() + Tsym * (nPreamble - 6)).raw();
+
+    for (size_t i = 0; i < numInterferers; i++) {
+        int64_t m_y = (batch.startTimes[i] + batch.endTimes[i]) / 2;
+        int64_t d_y = (batch.endTimes[i] - batch.startTimes[i]) / 2;
+        bool overlap = std::abs(m_x - m_y) < d_x + d_y;
+        bool frequencyCollision = batch.centerFrequencies[i] == centerFrequency;
+        bool captureEffect = signalPower >= captureRatio * batch.powers[i] || batch.powers[i] >= captureRatio * signalPower;
+        bool timingCollision = csBegin < batch.endTimes[i]; //Collision is acceptable in first part of preamble
+        batch.collided[i] = overlap & frequencyCollision & !captureEffect & timingCollision;
+    }
 
-        simtime_t m_y = (loRaInterference->getStartTime() + loRaInterference->getEndTime()) / 2;
-        simtime_t d_y = (loRaInterference->getEndTime() - loRaInterference->getStartTime()) / 2;
-        if (omnetpp::fabs(m_x - m_y) < d_x + d_y) {
-            overlap = true;
-        }
-
-        if (loRaReception->getLoRaCF() == loRaInterference->getLoRaCF()) {
-            frequencyCollision = true;
-        }
-
-        W interferenceRSSI_w = loRaInterference->getPower();
-        double interferenceRSSI_mw = interferenceRSSI_w.get() * 1000;
-        double interferenceRSSI_dBm = math::mW2dBmW(interferenceRSSI_mw);
-        int interferenceSF = loRaInterference->getLoRaSF();
-
-        /* If difference in power between two signals is greater than threshold, no collision*/
-        int acceptableDif = 12;
-        if (std::abs(signalRSSI_dBm - interferenceRSSI_dBm) >= acceptableDif) {
-            captureEffect = true;
-        }
-
-        EV << "[MSDEBUG] Received packet at SF: " << receptionSF << " with power " << signalRSSI_dBm << endl;
-        EV << "[MSDEBUG] Received interference at SF: " << interferenceSF << " with power " << interferenceRSSI_dBm << endl;
-        EV << "[MSDEBUG] Acceptable diff is equal " << acceptableDif << endl;
-        EV << "[MSDEBUG] Diff is equal " << signalRSSI_dBm - interferenceRSSI_dBm << endl;
-        if (captureEffect == false) {
-            EV << "[MSDEBUG] Packet is discarded" << endl;
-        }
-        else
-            EV << "[MSDEBUG] Packet is not discarded" << endl;
-
-        /* If last 6 symbols of preamble are received, no collision*/
-        double nPreamble = 8; //from the paper "Do Lora networks..."
-        simtime_t Tsym = (pow(2, loRaReception->getLoRaSF())) / (loRaReception->getLoRaBW().get() / 1000) / 1000;
-        simtime_t csBegin = loRaReception->getPreambleStartTime() + Tsym * (nPreamble - 6);
-        if (csBegin < loRaInterference->getEndTime()) {
-            timingCollision = true;
-        }
-        LoRaReceiver *receiverInstance = check_and_cast<LoRaReceiver*>(getModuleByPath("."));
-
-        if (overlap && frequencyCollision && captureEffect == false && timingCollision) {
-            receiverInstance->emit(receiverInstance->LoRaReceptionCollision, true);
+    bool isCollided = false;
+    int id1 = reception->getTransmission()->getId();
+    LoRaReceiver *receiverInstance = const_cast<LoRaReceiver*>(this);
+    for (size_t i = 0; i < numInterferers; i++) {
+        const ITransmission *interferingTransmission = batch.receptions[i]->getTransmission();
+        int id2 = interferingTransmission->getId();
+        bool hasUsefulData = loRaTransmission->hasUsefulData() || batch.usefulData[i];
+        if (hasUsefulData)
+            DataLogger::getInstance()->logPossibleCollision(id1, id2);
+        if (batch.collided[i]) {
+            receiverInstance->emit(LoRaReceptionCollision, true);
             isCollided = true;
-            if (messageInfoTag1->getHasUsefulData() || messageInfoTag2->getHasUsefulData()) {
-                if (messageInfoTag1->getHasUsefulData())
-                    EV << "This message has useful data: " << reception->getTransmission()->getPacket()->getName() << endl;
-                if (messageInfoTag2->getHasUsefulData())
-                    EV << "This message has useful data: " << interferingReception->getTransmission()->getPacket()->getName() << endl;
-
-                EV << "Collision: " << reception->getTransmission()->getPacket()->getName() << ", WITH, " << interferingReception->getTransmission()->getPacket()->getName() << endl;
+            if (hasUsefulData) {
+                EV << "Collision: " << reception->getTransmission()->getPacket()->getName() << ", WITH, " << interferingTransmission->getPacket()->getName() << endl;
                 DataLogger::getInstance()->logCollision(id1, id2);
             }
-
         }
     }
     return isCollided;
@@ -198,14 +174,21 @@ const IReceptionDecision* LoRaReceiver::computeReceptionDecision(const IListenin
     auto isReceptionPossible = computeIsReceptionPossible(listening, reception, part);
     auto isReceptionAttempted = isReceptionPossible && computeIsReceptionAttempted(listening, reception, part, interference);
     auto isReceptionSuccessful = isReceptionAttempted && computeIsReceptionSuccessful(listening, reception, part, interference, snir);
-    return new ReceptionDecision(reception, part, isReceptionPossible, isReceptionAttempted, isReceptionSuccessful);
+    return new LoRaPooled<ReceptionDecision>(reception, part, isReceptionPossible, isReceptionAttempted, isReceptionSuccessful);
 }
 
 Packet* LoRaReceiver::computeReceivedPacket(const ISnir *snir, bool isReceptionSuccessful) const
 {
-    auto transmittedPacket = snir->getReception()->getTransmission()->getPacket();
-    auto receivedPacket = transmittedPacket->dup();
-    receivedPacket->clearTags();
+    return computeReceivedPacket(snir->getReception(), isReceptionSuccessful);
+}
+
+Packet* LoRaReceiver::computeReceivedPacket(const IReception *reception, bool isReceptionSuccessful) const
+{
+    auto transmittedPacket = reception->getTransmission()->getPacket();
+    // the chunks are immutable, so every receiver shares them with the transmitted packet
+    // instead of duplicating the whole packet and clearing its tags
+    auto receivedPacket = new Packet(transmittedPacket->getName(), transmittedPacket->peekAll());
+    receivedPacket->setKind(transmittedPacket->getKind());
 
     auto msgInfoTag = transmittedPacket->findTag<MessageInfoTag>();
     if (msgInfoTag != nullptr) {
@@ -223,31 +206,43 @@ const IReceptionResult* LoRaReceiver::computeReceptionResult(const IListening *l
     bool isReceptionSuccessful = true;
     for (auto decision : *decisions)
         isReceptionSuccessful &= decision->isReceptionSuccessful();
-    auto packet = computeReceivedPacket(snir, isReceptionSuccessful);
+    auto packet = computeReceivedPacket(reception, isReceptionSuccessful);
 
     auto signalPowerInd = packet->addTagIfAbsent<SignalPowerInd>();
     const LoRaReception *loRaReception = check_and_cast<const LoRaReception*>(reception);
     W signalRSSI_w = loRaReception->getPower();
     signalPowerInd->setPower(signalRSSI_w);
 
-    auto snirInd = packet->addTagIfAbsent<SnirInd>();
-    snirInd->setMinimumSnir(snir->getMin());
-    snirInd->setMaximumSnir(snir->getMax());
     auto signalTimeInd = packet->addTagIfAbsent<SignalTimeInd>();
     signalTimeInd->setStartTime(reception->getStartTime());
     signalTimeInd->setEndTime(reception->getEndTime());
-    auto errorRateInd = packet->addTagIfAbsent<ErrorRateInd>();
-    errorRateInd->setPacketErrorRate(errorModel ? errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-    errorRateInd->setBitErrorRate(errorModel ? errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-    errorRateInd->setSymbolErrorRate(errorModel ? errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
 
-    return new ReceptionResult(reception, decisions, packet);
+    // the medium only computes the SNIR if the indications are enabled or the error model needs it
+    if (snir != nullptr) {
+        auto snirInd = packet->addTagIfAbsent<SnirInd>();
+        snirInd->setMinimumSnir(snir->getMin());
+        snirInd->setMaximumSnir(snir->getMax());
+        auto errorRateInd = packet->addTagIfAbsent<ErrorRateInd>();
+        errorRateInd->setPacketErrorRate(errorModel ? errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
+        errorRateInd->setBitErrorRate(errorModel ? errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
+        errorRateInd->setSymbolErrorRate(errorModel ? errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
+    }
+
+    return new LoRaPooled<ReceptionResult>(reception, decisions, packet);
 }
 
 bool LoRaReceiver::computeIsReceptionSuccessful(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
 {
-    return true;
-    //we don't check the SINR level, it is done in collision checking by P_threshold level evaluation
+    // without an error model the SINR level isn't checked, it is done in collision checking by P_threshold level evaluation
+    if (errorModel == nullptr)
+        return true;
+    double packetErrorRate = errorModel->computePacketErrorRate(snir, part);
+    if (packetErrorRate == 0.0)
+        return true;
+    else if (packetErrorRate == 1.0)
+        return false;
+    else
+        return dblrand() > packetErrorRate;
 }
 
 const IListening* LoRaReceiver::createListening(const IRadio *radio, const simtime_t startTime, const simtime_t endTime, const Coord &startPosition, const Coord &endPosition) const
@@ -268,80 +263,24 @@ const IListeningDecision* LoRaReceiver::computeListeningDecision(const IListenin
     const IRadio *receiver = listening->getReceiver();
     const IRadioMedium *radioMedium = receiver->getMedium();
     const IAnalogModel *analogModel = radioMedium->getAnalogModel();
-    const INoise *noise = analogModel->computeNoise(listening, interference);
-    const ScalarNoise *loRaNoise = check_and_cast<const ScalarNoise*>(noise);
-    W maxPower = loRaNoise->computeMaxPower(listening->getStartTime(), listening->getEndTime());
+    W maxPower;
+    if (auto loRaAnalogModel = dynamic_cast<const LoRaAnalogModel*>(analogModel))
+        maxPower = loRaAnalogModel->computeMaxNoisePower(listening, interference, listening->getStartTime(), listening->getEndTime());
+    else {
+        const INoise *noise = analogModel->computeNoise(listening, interference);
+        const ScalarNoise *loRaNoise = check_and_cast<const ScalarNoise*>(noise);
+        maxPower = loRaNoise->computeMaxPower(listening->getStartTime(), listening->getEndTime());
+        delete noise;
+    }
     bool isListeningPossible = maxPower >= energyDetection;
-    delete noise;
     EV_DEBUG << "Computing whether listening is possible: maximum power = " << maxPower << ", energy detection = " << energyDetection << " -> listening is " << (isListeningPossible ? "possible" : "impossible") << endl;
-    return new ListeningDecision(listening, isListeningPossible);
+    return new LoRaPooled<ListeningDecision>(listening, isListeningPossible);
 }
 
 W LoRaReceiver::getSensitivity(const LoRaReception *reception) const
 {
     //function returns sensitivity -- according to LoRa documentation, it changes with LoRa parameters
-    //Sensitivity values from Semtech SX1272/73 datasheet, table 10, Rev 3.1, March 2017
-    W sensitivity = W(math::dBmW2mW(-126.5) / 1000);
-    if (reception->getLoRaSF() == 6) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-121) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-118) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-111) / 1000);
-    }
-
-    if (reception->getLoRaSF() == 7) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-124) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            // -122
-            sensitivity = W(math::dBmW2mW(-124.5) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-116) / 1000);
-    }
-
-    if (reception->getLoRaSF() == 8) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-127) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-125) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-119) / 1000);
-    }
-    if (reception->getLoRaSF() == 9) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-130) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-128) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-122) / 1000);
-    }
-    if (reception->getLoRaSF() == 10) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-133) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-130) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-125) / 1000);
-    }
-    if (reception->getLoRaSF() == 11) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-135) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-132) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-128) / 1000);
-    }
-    if (reception->getLoRaSF() == 12) {
-        if (reception->getLoRaBW() == Hz(125000))
-            sensitivity = W(math::dBmW2mW(-137) / 1000);
-        if (reception->getLoRaBW() == Hz(250000))
-            sensitivity = W(math::dBmW2mW(-135) / 1000);
-        if (reception->getLoRaBW() == Hz(500000))
-            sensitivity = W(math::dBmW2mW(-129) / 1000);
-    }
-    return sensitivity;
+    return LoRaSensitivityTable::getSensitivity(reception->getLoRaSF(), reception->getLoRaBW());
 }
 
 }
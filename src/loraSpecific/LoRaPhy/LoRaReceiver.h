@@ -42,6 +42,34 @@ class LoRaReceiver : public FlatReceiverBase
 protected:
     simsignal_t LoRaReceptionCollision;
 
+    /**
+     * The interferers of the reception under test in structure-of-arrays
+     * layout, so that the collision criteria are evaluated in one flat loop.
+     * Reused between the calls.
+     */
+    struct InterfererBatch
+    {
+        std::vector<const LoRaReception *> receptions;
+        std::vector<int64_t> startTimes;
+        std::vector<int64_t> endTimes;
+        std::vector<double> powers;
+        std::vector<double> centerFrequencies;
+        std::vector<char> usefulData;
+        std::vector<char> collided;
+
+        void clear()
+        {
+            receptions.clear();
+            startTimes.clear();
+            endTimes.clear();
+            powers.clear();
+            centerFrequencies.clear();
+            usefulData.clear();
+            collided.clear();
+        }
+    };
+    mutable InterfererBatch interfererBatch;
+
 private:
     W LoRaTP;
     Hz LoRaCF;
@@ -81,6 +109,9 @@ public:
   virtual bool computeIsReceptionAttempted(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const override;
 
   virtual Packet * computeReceivedPacket(const ISnir *snir, bool isReceptionSuccessful) const override;
+  virtual Packet * computeReceivedPacket(const IReception *reception, bool isReceptionSuccessful) const;
+  /** Whether the reception decisions and results depend on the SNIR. */
+  virtual bool isSnirNeeded() const { return errorModel != nullptr; }
 
   virtual const IReceptionDecision *computeReceptionDecision(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const override;
   virtual const IReceptionResult *computeReceptionResult(const IListening *listening, const IReception *reception, const IInterference *interference, const ISnir *snir, const std::vector<const IReceptionDecision *> *decisions) const override;
@@ -9,6 +9,7 @@
 #define LORAPHY_LORARECEPTION_H_
 
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarReception.h"
+#include "LoRaObjectPool.h"
 
 using namespace inet;
 using namespace inet::physicallayer;
@@ -32,6 +33,9 @@ protected:
 
     virtual W getPower() const override { return receivedPower; }
     virtual W computeMinPower(simtime_t startTime, simtime_t endTime) const override;
+
+    static void *operator new(size_t size) { return LoRaObjectPool<LoRaReception>::allocate(size); }
+    static void operator delete(void *object, size_t size) { LoRaObjectPool<LoRaReception>::deallocate(object, size); }
 };
 
 } // namespace inet
@@ -0,0 +1,89 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORASENSITIVITYTABLE_H_
+#define LORAPHY_LORASENSITIVITYTABLE_H_
+
+#include "inet/common/Units.h"
+
+using namespace inet;
+using namespace inet::units::values;
+
+namespace rlora {
+
+static constexpr double LORA_DEFAULT_SENSITIVITY_W = 2.238721138568338e-16; // -126.5 dBm
+
+// indexed by [SF - 6][125 kHz, 250 kHz, 500 kHz]
+static constexpr double LORA_SENSITIVITY_W[7][3] = {
+    {7.9432823472428212e-16, 1.584893192461111e-15, 7.9432823472428218e-15},   // SF6: -121, -118, -111 dBm
+    {3.981071705534969e-16, 3.5481338923357605e-16, 2.5118864315095825e-15},   // SF7: -124, -124.5, -116 dBm
+    {1.9952623149688827e-16, 3.1622776601683793e-16, 1.2589254117941661e-15},   // SF8: -127, -125, -119 dBm
+    {9.9999999999999998e-17, 1.5848931924611109e-16, 6.3095734448019419e-16},   // SF9: -130, -128, -122 dBm
+    {5.0118723362727144e-17, 9.9999999999999998e-17, 3.1622776601683793e-16},   // SF10: -133, -130, -125 dBm
+    {3.1622776601683796e-17, 6.3095734448019427e-17, 1.5848931924611109e-16},   // SF11: -135, -132, -128 dBm
+    {1.9952623149688827e-17, 3.1622776601683796e-17, 1.2589254117941662e-16},   // SF12: -137, -135, -129 dBm
+};
+
+// same as the sensitivity except for SF7 at 250 kHz (-122 dBm)
+static constexpr double LORA_NOISE_FLOOR_W[7][3] = {
+    {7.9432823472428212e-16, 1.584893192461111e-15, 7.9432823472428218e-15},   // SF6: -121, -118, -111 dBm
+    {3.981071705534969e-16, 6.3095734448019419e-16, 2.5118864315095825e-15},   // SF7: -124, -122, -116 dBm
+    {1.9952623149688827e-16, 3.1622776601683793e-16, 1.2589254117941661e-15},   // SF8: -127, -125, -119 dBm
+    {9.9999999999999998e-17, 1.5848931924611109e-16, 6.3095734448019419e-16},   // SF9: -130, -128, -122 dBm
+    {5.0118723362727144e-17, 9.9999999999999998e-17, 3.1622776601683793e-16},   // SF10: -133, -130, -125 dBm
+    {3.1622776601683796e-17, 6.3095734448019427e-17, 1.5848931924611109e-16},   // SF11: -135, -132, -128 dBm
+    {1.9952623149688827e-17, 3.1622776601683796e-17, 1.2589254117941662e-16},   // SF12: -137, -135, -129 dBm
+};
+
+/**
+ * Receiver sensitivity and background noise power per spreading factor and
+ * bandwidth, precomputed in W. Values from Semtech SX1272/73 datasheet,
+ * table 10, Rev 3.1, March 2017. Combinations outside SF6-12 and
+ * 125/250/500 kHz fall back to -126.5 dBm.
+ */
+class LoRaSensitivityTable
+{
+  public:
+    static constexpr int MIN_SF = 6;
+    static constexpr int MAX_SF = 12;
+    static constexpr int NUM_SF = MAX_SF - MIN_SF + 1;
+    static constexpr int NUM_BW = 3;
+
+    /** Returns the column of the bandwidth or -1 if it is not tabulated. */
+    static int getBandwidthIndex(Hz bandwidth)
+    {
+        double bw = bandwidth.get();
+        return bw == 125000 ? 0 : bw == 250000 ? 1 : bw == 500000 ? 2 : -1;
+    }
+
+    static bool isTabulated(int spreadFactor, Hz bandwidth)
+    {
+        return spreadFactor >= MIN_SF && spreadFactor <= MAX_SF && getBandwidthIndex(bandwidth) != -1;
+    }
+
+    static W getSensitivity(int spreadFactor, Hz bandwidth)
+    {
+        return W(isTabulated(spreadFactor, bandwidth) ? LORA_SENSITIVITY_W[spreadFactor - MIN_SF][getBandwidthIndex(bandwidth)] : LORA_DEFAULT_SENSITIVITY_W);
+    }
+
+    static W getNoiseFloor(int spreadFactor, Hz bandwidth)
+    {
+        return W(isTabulated(spreadFactor, bandwidth) ? LORA_NOISE_FLOOR_W[spreadFactor - MIN_SF][getBandwidthIndex(bandwidth)] : LORA_DEFAULT_SENSITIVITY_W);
+    }
+};
+
+} // namespace rlora
+
+#endif /* LORAPHY_LORASENSITIVITYTABLE_H_ */
@@ -0,0 +1,78 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaTimeOnAir.h"
+#include <cmath>
+
+namespace rlora {
+
+static const Hz tabulatedBandwidths[LoRaSensitivityTable::NUM_BW] = {Hz(125000), Hz(250000), Hz(500000)};
+
+LoRaTimeOnAir::Table::Table() :
+    durations(LoRaSensitivityTable::NUM_SF * LoRaSensitivityTable::NUM_BW * (MAX_CR - MIN_CR + 1) * (MAX_PAYLOAD_BYTES + 1))
+{
+    for (int sf = LoRaSensitivityTable::MIN_SF; sf <= LoRaSensitivityTable::MAX_SF; sf++)
+        for (int bwIndex = 0; bwIndex < LoRaSensitivityTable::NUM_BW; bwIndex++)
+            for (int cr = MIN_CR; cr <= MAX_CR; cr++)
+                for (int bytes = 0; bytes <= MAX_PAYLOAD_BYTES; bytes++)
+                    durations[getIndex(sf, bwIndex, cr, bytes)] = computeTimeOnAir(sf, tabulatedBandwidths[bwIndex], cr, bytes);
+}
+
+simtime_t LoRaTimeOnAir::Table::get(int spreadFactor, int bandwidthIndex, int codeRate, int payloadBytes) const
+{
+    return durations[getIndex(spreadFactor, bandwidthIndex, codeRate, payloadBytes)];
+}
+
+const LoRaTimeOnAir::Table& LoRaTimeOnAir::getTable()
+{
+    static const Table table;
+    return table;
+}
+
+int LoRaTimeOnAir::getIndex(int spreadFactor, int bandwidthIndex, int codeRate, int payloadBytes)
+{
+    int index = spreadFactor - LoRaSensitivityTable::MIN_SF;
+    index = index * LoRaSensitivityTable::NUM_BW + bandwidthIndex;
+    index = index * (MAX_CR - MIN_CR + 1) + codeRate - MIN_CR;
+    return index * (MAX_PAYLOAD_BYTES + 1) + payloadBytes;
+}
+
+int LoRaTimeOnAir::getPayloadSymbols(int spreadFactor, int codeRate, int payloadBytes)
+{
+    // explicit header (IH = 0), CRC on, no low data rate optimization (DE = 0)
+    double payloadSymbNb = std::ceil((8.0 * payloadBytes - 4 * spreadFactor + 28 + 16 - 20 * 0) / (4 * (spreadFactor - 2 * 0))) * (codeRate + 4);
+    return payloadSymbNb < 0 ? 0 : (int)payloadSymbNb;
+}
+
+simtime_t LoRaTimeOnAir::computeTimeOnAir(int spreadFactor, Hz bandwidth, int codeRate, int payloadBytes)
+{
+    // rounded separately, the transmission is built from the same three parts
+    simtime_t preambleDuration = getPreambleDuration(spreadFactor, bandwidth);
+    simtime_t headerDuration = getHeaderDuration(spreadFactor, bandwidth);
+    simtime_t payloadDuration = getPayloadDuration(spreadFactor, bandwidth, codeRate, payloadBytes);
+    return preambleDuration + headerDuration + payloadDuration;
+}
+
+simtime_t LoRaTimeOnAir::getTimeOnAir(int spreadFactor, Hz bandwidth, int codeRate, int payloadBytes)
+{
+    int bandwidthIndex = LoRaSensitivityTable::getBandwidthIndex(bandwidth);
+    if (bandwidthIndex != -1 && spreadFactor >= LoRaSensitivityTable::MIN_SF && spreadFactor <= LoRaSensitivityTable::MAX_SF &&
+        codeRate >= MIN_CR && codeRate <= MAX_CR && payloadBytes >= 0 && payloadBytes <= MAX_PAYLOAD_BYTES)
+        return getTable().get(spreadFactor, bandwidthIndex, codeRate, payloadBytes);
+    else
+        return computeTimeOnAir(spreadFactor, bandwidth, codeRate, payloadBytes);
+}
+
+} // namespace rlora
@@ -0,0 +1,78 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORATIMEONAIR_H_
+#define LORAPHY_LORATIMEONAIR_H_
+
+#include "inet/common/INETDefs.h"
+#include "inet/common/Units.h"
+#include "LoRaSensitivityTable.h"
+#include <cmath>
+#include <vector>
+
+using namespace inet;
+using namespace inet::units::values;
+
+namespace rlora {
+
+/**
+ * Time on air of a LoRa frame (8 preamble symbols + 4.25 sync symbols,
+ * 8 header symbols, explicit header, CRC on, no low data rate optimization).
+ * Both the PHY and the MAC use getTimeOnAir, so that the MAC's predictions
+ * match the transmission durations exactly. The frame duration is the sum of
+ * the preamble, header and payload durations each rounded to simtime, like
+ * the parts of the transmission. The durations for SF6-12, 125/250/500 kHz,
+ * CR1-4 and 0-255 bytes are precomputed on first use, other combinations are
+ * computed with the same formula.
+ */
+class LoRaTimeOnAir
+{
+  public:
+    static constexpr int NUM_PREAMBLE_SYMBOLS = 8;
+    static constexpr int NUM_HEADER_SYMBOLS = 8;
+    static constexpr int MIN_CR = 1;
+    static constexpr int MAX_CR = 4;
+    static constexpr int MAX_PAYLOAD_BYTES = 255;
+
+  protected:
+    class Table
+    {
+      protected:
+        std::vector<simtime_t> durations;
+
+      public:
+        Table();
+        simtime_t get(int spreadFactor, int bandwidthIndex, int codeRate, int payloadBytes) const;
+    };
+
+    static const Table& getTable();
+    static int getIndex(int spreadFactor, int bandwidthIndex, int codeRate, int payloadBytes);
+
+  public:
+    /** Returns the symbol duration in seconds. */
+    static double getSymbolDuration(int spreadFactor, Hz bandwidth) { return std::ldexp(1.0, spreadFactor) / bandwidth.get(); }
+    static double getPreambleDuration(int spreadFactor, Hz bandwidth) { return (NUM_PREAMBLE_SYMBOLS + 4.25) * getSymbolDuration(spreadFactor, bandwidth); }
+    static double getHeaderDuration(int spreadFactor, Hz bandwidth) { return NUM_HEADER_SYMBOLS * getSymbolDuration(spreadFactor, bandwidth); }
+    static int getPayloadSymbols(int spreadFactor, int codeRate, int payloadBytes);
+    static double getPayloadDuration(int spreadFactor, Hz bandwidth, int codeRate, int payloadBytes) { return getPayloadSymbols(spreadFactor, codeRate, payloadBytes) * getSymbolDuration(spreadFactor, bandwidth); }
+
+    /** Returns the duration of the whole frame, the sum of the rounded parts. */
+    static simtime_t getTimeOnAir(int spreadFactor, Hz bandwidth, int codeRate, int payloadBytes);
+    static simtime_t computeTimeOnAir(int spreadFactor, Hz bandwidth, int codeRate, int payloadBytes);
+};
+
+} // namespace rlora
+
+#endif /* LORAPHY_LORATIMEONAIR_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "LoRaTransmission.h"
+#include "../../common/tags/MessageInfoTag_m.h"
 
 namespace rlora {
 LoRaTransmission::LoRaTransmission(const IRadio *transmitter, const Packet *macFrame, const simtime_t startTime, const simtime_t endTime, const simtime_t preambleDuration, const simtime_t headerDuration, const simtime_t dataDuration, const Coord startPosition, const Coord endPosition, const Quaternion startOrientation, const Quaternion endOrientation, W LoRaTP, Hz LoRaCF, int LoRaSF, Hz LoRaBW, int LoRaCR):
@@ -14,7 +15,8 @@ LoRaTransmission::LoRaTransmission(const IRadio *transmitter, const Packet *macF
         LoRaCF(LoRaCF),
         LoRaSF(LoRaSF),
         LoRaBW(LoRaBW),
-        LoRaCR(LoRaCR)
+        LoRaCR(LoRaCR),
+        usefulData(macFrame->findTag<MessageInfoTag>() != nullptr && macFrame->getTag<MessageInfoTag>()->getHasUsefulData())
 {
     // TODO Auto-generated constructor stub
 
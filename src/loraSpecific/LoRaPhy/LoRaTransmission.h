@@ -22,6 +22,8 @@ protected:
     const int LoRaSF;
     const Hz LoRaBW;
     const int LoRaCR;
+    // cached from the MessageInfoTag, the collision check needs it for every interferer
+    const bool usefulData;
 public:
     LoRaTransmission(const IRadio *transmitter, const Packet *macFrame, const simtime_t startTime, const simtime_t endTime, const simtime_t preambleDuration, const simtime_t headerDuration, const simtime_t dataDuration, const Coord startPosition, const Coord endPosition, const Quaternion startOrientation, const Quaternion endOrientation, W LoRaTP, Hz LoRaCF, int LoRaSF, Hz LoRaBW, int LoRaCR);
 
@@ -35,6 +37,7 @@ public:
     int getLoRaSF() const { return LoRaSF; }
     Hz getLoRaBW() const { return LoRaBW; }
     int getLoRaCR() const { return LoRaCR; }
+    bool hasUsefulData() const { return usefulData; }
 
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
 };
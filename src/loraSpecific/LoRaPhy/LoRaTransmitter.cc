@@ -17,6 +17,7 @@
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarTransmission.h"
 #include "LoRaModulation.h"
 #include "LoRaPhyPreamble_m.h"
+#include "LoRaTimeOnAir.h"
 #include "../LoRa/LoRaMacFrame_m.h"
 #include <algorithm>
 
@@ -69,33 +70,18 @@ const ITransmission* LoRaTransmitter::createTransmission(const IRadio *transmitt
     EV << macFrame->getDetailStringRepresentation(evFlags) << endl;
     const auto &frame = macFrame->peekAtFront<LoRaPhyPreamble>();
 
-    double sf = frame->getSpreadFactor();
-    double bw = frame->getBandwidth().get();
-    double cr = frame->getCodeRendundance();
-
-//    const LoRaMacFrame *frame = check_and_cast<const LoRaMacFrame *>(macFrame);
-
-    int nPreamble = 8;
-    simtime_t Tsym = (pow(2, sf)) / (bw / 1000);
-    simtime_t Tpreamble = (nPreamble + 4.25) * Tsym / 1000;
-    simtime_t Theader = 8 * Tsym / 1000;
-
-    int payloadBytes = 0;
-
-    const auto &mac = macFrame->peekDataAt<LoRaMacFrame>(frame->getChunkLength());
-    double macSize = B(mac->getChunkLength()).get();
-
-    const auto &payload = macFrame->peekDataAt(frame->getChunkLength() + mac->getChunkLength());
-
-    double payloadSize = B(macFrame->getByteLength()).get();
+    int sf = frame->getSpreadFactor();
+    Hz bw = frame->getBandwidth();
+    int cr = frame->getCodeRendundance();
 
     // for us mac header and payload are the "real Payload"
-    payloadBytes = payloadSize;
-
-    double payloadSymbNb = std::ceil((8 * payloadBytes - 4 * sf + 28 + 16 - 20 * 0) / (4 * (sf - 2 * 0))) * (cr + 4);
-    simtime_t Tpayload = payloadSymbNb * Tsym / 1000;
+    int payloadBytes = macFrame->getByteLength();
 
-    const simtime_t duration = Tpreamble + Theader + Tpayload;
+    // the same duration the MAC predicts, the payload takes the rest so the parts add up exactly
+    const simtime_t duration = LoRaTimeOnAir::getTimeOnAir(sf, bw, cr, payloadBytes);
+    simtime_t Tpreamble = LoRaTimeOnAir::getPreambleDuration(sf, bw);
+    simtime_t Theader = LoRaTimeOnAir::getHeaderDuration(sf, bw);
+    simtime_t Tpayload = duration - Tpreamble - Theader;
     const simtime_t endTime = startTime + duration;
     IMobility *mobility = transmitter->getAntenna()->getMobility();
     const Coord startPosition = mobility->getCurrentPosition();
@@ -105,19 +105,20 @@ namespace rlora
                 cMessage *readyMsg = new cMessage("Ready");
                 sendUp(readyMsg);
 
-                if (!result.completePacket.isMission || result.completePacket.sourceNode == nodeId)
+                const FragmentedPacket *completePacket = result.completePacket;
+                if (!completePacket->isMission || completePacket->sourceNode == nodeId)
                 {
                     return;
                 }
 
-                emit(receivedMissionId, result.completePacket.missionId);
+                emit(receivedMissionId, completePacket->missionId);
                 if (packetQueue.size() < 4000)
                 {
-                    createPacket(result.completePacket.size, result.completePacket.missionId, result.completePacket.sourceNode, result.completePacket.isMission);
+                    createPacket(completePacket->size, completePacket->missionId, completePacket->sourceNode, completePacket->isMission);
                 }
-            }
 
-            removePacketById(result.completePacket.missionId, result.completePacket.messageId, result.isMission);
+                removePacketById(completePacket->missionId, completePacket->messageId, result.isMission);
+            }
         }
     }
 
@@ -1,4 +1,5 @@
 #include "MacContext.h"
+#include "../loraSpecific/LoRaPhy/LoRaTimeOnAir.h"
 
 namespace rlora
 {
@@ -59,24 +60,7 @@ namespace rlora
 
     double MacContext::predictOngoingMsgTime(int packetBytes)
     {
-        double sf = loRaRadio->loRaSF;
-        double bw = loRaRadio->loRaBW.get();
-        double cr = loRaRadio->loRaCR;
-        simtime_t Tsym = (pow(2, sf)) / (bw / 1000);
-
-        double preambleSymbNb = 8;
-        double headerSymbNb = 8;
-        double payloadSymbNb = std::ceil((8 * packetBytes - 4 * sf + 28 + 16 - 20 * 0) / (4 * (sf - 2 * 0))) * (cr + 4);
-        if (payloadSymbNb < 0)
-            payloadSymbNb = 0;
-
-        simtime_t Tpreamble = (preambleSymbNb + 4.25) * Tsym / 1000;
-        simtime_t Theader = headerSymbNb * Tsym / 1000;
-        ;
-        simtime_t Tpayload = payloadSymbNb * Tsym / 1000;
-
-        const simtime_t duration = Tpreamble + Theader + Tpayload;
-        return duration.dbl();
+        return LoRaTimeOnAir::getTimeOnAir(loRaRadio->loRaSF, loRaRadio->loRaBW, loRaRadio->loRaCR, packetBytes).dbl();
     }
 
 };
\ No newline at end of file
@@ -15,6 +15,12 @@ namespace rlora
             {
                 this->logReceivedFragmentId(id);
             });
+
+        packetQueue.setFragmentMaterializer(
+            [this](const FragmentDescriptor &fragment)
+            {
+                return this->createFragment(fragment);
+            });
     }
 
     void PacketBase::logReceivedFragmentId(int id)
@@ -24,11 +30,7 @@ namespace rlora
 
     void PacketBase::finishPacketBase()
     {
-        while (!packetQueue.isEmpty())
-        {
-            auto *pkt = packetQueue.dequeuePacket();
-            delete pkt;
-        }
+        packetQueue.clear();
     }
 
     Result PacketBase::addToIncompletePacket(const BroadcastFragment *pkt, bool isMission)
@@ -66,19 +68,15 @@ namespace rlora
         return packetQueue.dequeuePacket();
     }
 
-    void PacketBase::encapsulate(Packet *msg)
+    const Ptr<const LoRaMacFrame>& PacketBase::getMacHeader(bool useHeader)
     {
+        if (macHeader != nullptr && macHeader->getTransmitterAddress() == address && macHeader->getLoRaTP() == loRaRadio->loRaTP && macHeader->getLoRaCF() == loRaRadio->loRaCF && macHeader->getLoRaSF() == loRaRadio->loRaSF && macHeader->getLoRaBW() == loRaRadio->loRaBW && macHeader->getLoRaCR() == loRaRadio->loRaCR && macHeader->getLoRaUseHeader() == useHeader)
+        {
+            return macHeader;
+        }
+
         auto frame = makeShared<LoRaMacFrame>();
         frame->setChunkLength(B(0));
-        msg->setArrival(msg->getArrivalModuleId(), msg->getArrivalGateId());
-
-        auto tag = msg->addTagIfAbsent<LoRaTag>();
-        tag->setBandwidth(loRaRadio->loRaBW);
-        tag->setCenterFrequency(loRaRadio->loRaCF);
-        tag->setSpreadFactor(loRaRadio->loRaSF);
-        tag->setCodeRendundance(loRaRadio->loRaCR);
-        tag->setPower(mW(math::dBmW2mW(loRaRadio->loRaTP)));
-
         frame->setTransmitterAddress(address);
         frame->setLoRaTP(loRaRadio->loRaTP);
         frame->setLoRaCF(loRaRadio->loRaCF);
@@ -87,10 +85,24 @@ namespace rlora
         frame->setLoRaCR(loRaRadio->loRaCR);
         frame->setSequenceNumber(0);
         frame->setReceiverAddress(MacAddress::BROADCAST_ADDRESS);
+        frame->setLoRaUseHeader(useHeader);
+        frame->markImmutable();
+        macHeader = frame;
+        return macHeader;
+    }
 
-        frame->setLoRaUseHeader(tag->getUseHeader());
+    void PacketBase::encapsulate(Packet *msg)
+    {
+        msg->setArrival(msg->getArrivalModuleId(), msg->getArrivalGateId());
 
-        msg->insertAtFront(frame);
+        auto tag = msg->addTagIfAbsent<LoRaTag>();
+        tag->setBandwidth(loRaRadio->loRaBW);
+        tag->setCenterFrequency(loRaRadio->loRaCF);
+        tag->setSpreadFactor(loRaRadio->loRaSF);
+        tag->setCodeRendundance(loRaRadio->loRaCR);
+        tag->setPower(mW(math::dBmW2mW(loRaRadio->loRaTP)));
+
+        msg->insertAtFront(getMacHeader(tag->getUseHeader()));
     }
 
     void PacketBase::decapsulate(Packet *frame)
@@ -157,41 +169,17 @@ namespace rlora
         int i = 1;
         while (payloadSize > 0)
         {
-            auto fragmentPacket = new Packet("BroadcastFragmentPkt");
-            auto fragmentPayload = makeShared<BroadcastFragment>();
-
-            if (payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE)
-            {
-                currentPayloadSize = MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE;
-                fragmentPayload->setChunkLength(B(MAXIMUM_PACKET_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = payloadSize - currentPayloadSize;
-            }
-            else
-            {
-                currentPayloadSize = payloadSize;
-                fragmentPayload->setChunkLength(B(currentPayloadSize + BROADCAST_FRAGMENT_META_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = 0;
-            }
+            currentPayloadSize = payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE ? MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE : payloadSize;
+            payloadSize = payloadSize - currentPayloadSize;
 
-            fragmentPayload->setMessageId(messageId);
-            fragmentPayload->setMissionId(missionId);
-            fragmentPayload->setSource(source);
-            fragmentPayload->setFragmentId(i++);
-            fragmentPacket->insertAtBack(fragmentPayload);
-            fragmentPacket->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
-
-            auto messageInfoTag = fragmentPacket->addTagIfAbsent<MessageInfoTag>();
-            messageInfoTag->setIsNeighbourMsg(!isMission);
-            messageInfoTag->setMissionId(missionId);
-            messageInfoTag->setIsHeader(false);
-            messageInfoTag->setHasUsefulData(true);
-            messageInfoTag->setPayloadSize(currentPayloadSize);
-            messageInfoTag->setMessageId(messageId);
-
-            encapsulate(fragmentPacket);
-            packetQueue.enqueuePacket(fragmentPacket);
+            FragmentDescriptor fragment;
+            fragment.messageId = messageId;
+            fragment.missionId = missionId;
+            fragment.source = source;
+            fragment.fragmentId = i++;
+            fragment.payloadSize = currentPayloadSize;
+            fragment.isNeighbourMsg = !isMission;
+            packetQueue.enqueueFragment(fragment);
         }
     }
 
@@ -219,53 +207,18 @@ namespace rlora
         int i = 0;
         while (payloadSize > 0)
         {
-            auto fragmentPacket = new Packet("BroadcastFragmentPkt");
-            auto fragmentPayload = makeShared<BroadcastFragment>();
-
-            int currentPayloadSize = 0;
-            if (payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE)
-            {
-                currentPayloadSize = MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE;
-                fragmentPayload->setChunkLength(B(MAXIMUM_PACKET_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = payloadSize - currentPayloadSize;
-            }
-            else
-            {
-                currentPayloadSize = payloadSize;
-                fragmentPayload->setChunkLength(B(currentPayloadSize + BROADCAST_FRAGMENT_META_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = 0;
-            }
-
-            fragmentPayload->setMissionId(missionId);
-            fragmentPayload->setMessageId(messageId);
-            fragmentPayload->setSource(source);
-            fragmentPayload->setFragmentId(i++);
-            fragmentPacket->insertAtBack(fragmentPayload);
-            fragmentPacket->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
-
-            auto messageInfoTag = fragmentPacket->addTagIfAbsent<MessageInfoTag>();
-            messageInfoTag->setIsNeighbourMsg(!isMission);
-            messageInfoTag->setMissionId(missionId);
-            messageInfoTag->setIsHeader(false);
-            messageInfoTag->setHasUsefulData(true);
-            messageInfoTag->setPayloadSize(currentPayloadSize);
-            messageInfoTag->setMessageId(messageId);
-
-            if (payloadSize == 0)
-            {
-                auto waitTimeTag = fragmentPacket->addTagIfAbsent<WaitTimeTag>();
-                waitTimeTag->setWaitTime(50 + 270 + intuniform(0, 50));
-            }
-            else
-            {
-                auto waitTimeTag = fragmentPacket->addTagIfAbsent<WaitTimeTag>();
-                waitTimeTag->setWaitTime(0);
-            }
+            int currentPayloadSize = payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE ? MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE : payloadSize;
+            payloadSize = payloadSize - currentPayloadSize;
 
-            encapsulate(fragmentPacket);
-            packetQueue.enqueuePacket(fragmentPacket);
+            FragmentDescriptor fragment;
+            fragment.messageId = messageId;
+            fragment.missionId = missionId;
+            fragment.source = source;
+            fragment.fragmentId = i++;
+            fragment.payloadSize = currentPayloadSize;
+            fragment.isNeighbourMsg = !isMission;
+            fragment.waitTime = payloadSize == 0 ? 50 + 270 + intuniform(0, 50) : 0;
+            packetQueue.enqueueFragment(fragment);
         }
     }
 
@@ -358,46 +311,57 @@ namespace rlora
                 hasRegularHeader = false;
             }
 
-            auto fragmentPacket = new Packet("BroadcastFragmentPkt");
-            auto fragmentPayload = makeShared<BroadcastFragment>();
+            int currentPayloadSize = payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE ? MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE : payloadSize;
+            payloadSize = payloadSize - currentPayloadSize;
 
-            int currentPayloadSize = 0;
-            if (payloadSize + BROADCAST_FRAGMENT_META_SIZE > MAXIMUM_PACKET_SIZE)
-            {
-                currentPayloadSize = MAXIMUM_PACKET_SIZE - BROADCAST_FRAGMENT_META_SIZE;
-                fragmentPayload->setChunkLength(B(MAXIMUM_PACKET_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = payloadSize - currentPayloadSize;
-            }
-            else
-            {
-                currentPayloadSize = payloadSize;
-                fragmentPayload->setChunkLength(B(currentPayloadSize + BROADCAST_FRAGMENT_META_SIZE));
-                fragmentPayload->setPayloadSize(currentPayloadSize);
-                payloadSize = 0;
-            }
+            FragmentDescriptor fragment;
+            fragment.messageId = messageId;
+            fragment.missionId = missionId;
+            fragment.source = source;
+            fragment.fragmentId = i++;
+            fragment.payloadSize = currentPayloadSize;
+            fragment.isNeighbourMsg = !isMission;
+            fragment.isContinuous = true;
+            fragment.hasRegularHeader = hasRegularHeader;
+            packetQueue.enqueueFragment(fragment);
+        }
+    }
 
-            fragmentPayload->setMissionId(missionId);
-            fragmentPayload->setMessageId(messageId);
-            fragmentPayload->setSource(source);
-            fragmentPayload->setFragmentId(i++);
-            fragmentPacket->insertAtBack(fragmentPayload);
-            fragmentPacket->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
-
-            auto messageInfoTag = fragmentPacket->addTagIfAbsent<MessageInfoTag>();
-            messageInfoTag->setIsNeighbourMsg(!isMission);
-            messageInfoTag->setMissionId(missionId);
-            messageInfoTag->setIsHeader(false);
+    Packet *PacketBase::createFragment(const FragmentDescriptor &fragment)
+    {
+        auto fragmentPacket = new Packet("BroadcastFragmentPkt");
+        auto fragmentPayload = makeShared<BroadcastFragment>();
+        fragmentPayload->setChunkLength(B(fragment.payloadSize + BROADCAST_FRAGMENT_META_SIZE));
+        fragmentPayload->setPayloadSize(fragment.payloadSize);
+        fragmentPayload->setMessageId(fragment.messageId);
+        fragmentPayload->setMissionId(fragment.missionId);
+        fragmentPayload->setSource(fragment.source);
+        fragmentPayload->setFragmentId(fragment.fragmentId);
+        fragmentPacket->insertAtBack(fragmentPayload);
+        fragmentPacket->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
+
+        auto messageInfoTag = fragmentPacket->addTagIfAbsent<MessageInfoTag>();
+        messageInfoTag->setIsNeighbourMsg(fragment.isNeighbourMsg);
+        messageInfoTag->setMissionId(fragment.missionId);
+        messageInfoTag->setIsHeader(false);
+        messageInfoTag->setHasUsefulData(true);
+        messageInfoTag->setPayloadSize(fragment.payloadSize);
+        messageInfoTag->setMessageId(fragment.messageId);
+        if (fragment.isContinuous)
+        {
             messageInfoTag->setHopId(nodeId);
-            messageInfoTag->setHasUsefulData(true);
-            messageInfoTag->setPayloadSize(currentPayloadSize);
-            messageInfoTag->setWithRTS(isMission);
-            messageInfoTag->setHasRegularHeader(hasRegularHeader);
-            messageInfoTag->setMessageId(messageId);
-
-            encapsulate(fragmentPacket);
-            packetQueue.enqueuePacket(fragmentPacket);
+            messageInfoTag->setWithRTS(!fragment.isNeighbourMsg);
+            messageInfoTag->setHasRegularHeader(fragment.hasRegularHeader);
         }
+
+        if (fragment.waitTime >= 0)
+        {
+            auto waitTimeTag = fragmentPacket->addTagIfAbsent<WaitTimeTag>();
+            waitTimeTag->setWaitTime(fragment.waitTime);
+        }
+
+        encapsulate(fragmentPacket);
+        return fragmentPacket;
     }
 
     void PacketBase::createNeighbourPacket(int payloadSize, int source, bool isMission)
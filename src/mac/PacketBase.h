@@ -29,6 +29,7 @@ namespace rlora
         void createBroadcastPacketWithContinuousRTS(int payloadSize, int missionId, int source, bool isMission);
         Packet *createHeader(int missionId, int source, int payloadSize, bool isMission);
         Packet *createContinuousHeader(int missionId, int source, int payloadSize, bool isMission);
+        Packet *createFragment(const FragmentDescriptor &fragment);
         void createNeighbourPacket(int payloadSize, int source, bool isMission);
         Packet *dequeueCustomPacket();
 
@@ -39,6 +40,11 @@ namespace rlora
         CustomPacketQueue packetQueue;
 
     private:
+        // The MAC header only depends on the radio settings, so one immutable chunk is
+        // shared by all frames of the node and only rebuilt when the settings change.
+        Ptr<const LoRaMacFrame> macHeader;
+
+        const Ptr<const LoRaMacFrame>& getMacHeader(bool useHeader);
     };
 }
 
@@ -104,7 +104,8 @@ namespace rlora
         if (packet != nullptr)
         {
             auto chunk = packet->peekAtFront<inet::Chunk>();
-            if (auto msg = dynamic_cast<const BroadcastRts *>(chunk.get()))
+            auto frame = asLoRaFrame(chunk.get());
+            if (auto msg = loRaFrameCast<BroadcastRts>(frame))
             {
                 return true;
             }
@@ -126,7 +127,8 @@ namespace rlora
         if (packet != nullptr)
         {
             auto chunk = packet->peekAtFront<inet::Chunk>();
-            if (auto msg = dynamic_cast<const BroadcastCTS *>(chunk.get()))
+            auto frame = asLoRaFrame(chunk.get());
+            if (auto msg = loRaFrameCast<BroadcastCTS>(frame))
             {
                 if (msg->getHopId() == nodeId)
                 {
@@ -143,7 +145,8 @@ namespace rlora
         if (packet != nullptr)
         {
             auto chunk = packet->peekAtFront<inet::Chunk>();
-            if (auto msg = dynamic_cast<const BroadcastCTS *>(chunk.get()))
+            auto frame = asLoRaFrame(chunk.get());
+            if (auto msg = loRaFrameCast<BroadcastCTS>(frame))
             {
                 if (msg->getHopId() == rtsSource)
                 {
@@ -217,7 +220,8 @@ namespace rlora
         if (packet != nullptr)
         {
             auto chunk = packet->peekAtFront<inet::Chunk>();
-            if (auto cts = dynamic_cast<const BroadcastCTS *>(chunk.get()))
+            auto frame = asLoRaFrame(chunk.get());
+            if (auto cts = loRaFrameCast<BroadcastCTS>(frame))
             {
                 if (cts->getHopId() != nodeId)
                 {
@@ -231,7 +235,8 @@ namespace rlora
     void RtsCtsBase::handleStrayCTS(Packet *packet, bool withRemainder)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
-        auto cts = dynamic_cast<const BroadcastCTS *>(chunk.get());
+        auto frame = asLoRaFrame(chunk.get());
+        auto cts = loRaFrameCast<BroadcastCTS>(frame);
 
         double scheduleTime = predictOngoingMsgTime(cts->getSizeOfFragment()) + sifs.dbl();
         if (withRemainder)
@@ -260,7 +265,8 @@ namespace rlora
         }
 
         auto chunk = packet->peekAtFront<inet::Chunk>();
-        if (auto fragment = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        auto frame = asLoRaFrame(chunk.get());
+        if (auto fragment = loRaFrameCast<BroadcastFragment>(frame))
         {
             auto infoTag = packet->getTag<MessageInfoTag>();
             if (infoTag->getHopId() == rtsSource)
@@ -280,7 +286,8 @@ namespace rlora
         }
 
         auto chunk = packet->peekAtFront<inet::Chunk>();
-        if (auto fragment = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        auto frame = asLoRaFrame(chunk.get());
+        if (auto fragment = loRaFrameCast<BroadcastFragment>(frame))
         {
             auto infoTag = packet->getTag<MessageInfoTag>();
             if (infoTag->getHopId() != rtsSource)
@@ -73,12 +73,13 @@ namespace rlora
     void Aloha::handlePacket(Packet *packet)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
+        auto frame = asLoRaFrame(chunk.get());
 
         logEffectiveReception(packet);
 
-        if (auto msg = dynamic_cast<const BroadcastLeaderFragment *>(chunk.get()))
+        if (auto msg = loRaFrameCast<BroadcastLeaderFragment>(frame))
             handleLeaderFragment(msg);
-        else if (auto msg = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastFragment>(frame))
             handleFragment(msg);
     }
 
@@ -100,11 +100,12 @@ namespace rlora
     void Csma::handlePacket(Packet *packet)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
+        auto frame = asLoRaFrame(chunk.get());
         logEffectiveReception(packet);
 
-        if (auto msg = dynamic_cast<const BroadcastLeaderFragment *>(chunk.get()))
+        if (auto msg = loRaFrameCast<BroadcastLeaderFragment>(frame))
             handleLeaderFragment(msg);
-        else if (auto msg = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastFragment>(frame))
             handleFragment(msg);
     }
 
@@ -91,9 +91,10 @@ namespace rlora
     void MeshRouter::handlePacket(Packet *packet)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
+        auto frame = asLoRaFrame(chunk.get());
         logEffectiveReception(packet);
 
-        if (auto msg = dynamic_cast<const BroadcastRts *>(chunk.get()))
+        if (auto msg = loRaFrameCast<BroadcastRts>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -121,7 +122,7 @@ namespace rlora
             int waitTime = 20 + predictSendTime(size);
             senderWaitDelay(waitTime);
         }
-        else if (auto msg = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastFragment>(frame))
         {
             int missionId = msg->getMissionId();
             bool isMissionMsg = missionId > 0;
@@ -208,11 +208,12 @@ namespace rlora
     void MiRS::handlePacket(Packet *packet)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
+        auto frame = asLoRaFrame(chunk.get());
         Ptr<const MessageInfoTag> infoTag = packet->getTag<MessageInfoTag>();
 
         logEffectiveReception(packet);
 
-        if (auto msg = dynamic_cast<const BroadcastRts *>(chunk.get()))
+        if (auto msg = loRaFrameCast<BroadcastRts>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -247,7 +248,7 @@ namespace rlora
                 setRTSsource(msg->getHop());
             }
         }
-        else if (auto msg = dynamic_cast<const BroadcastLeaderFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastLeaderFragment>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -284,7 +285,7 @@ namespace rlora
             retransmitPacket(result);
             delete fragmentPayload;
         }
-        else if (auto msg = dynamic_cast<const BroadcastContinuousRts *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastContinuousRts>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -298,9 +299,9 @@ namespace rlora
                 setRTSsource(msg->getHopId());
             }
         }
-        else if (auto msg = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastFragment>(frame))
             handleFragment(msg, infoTag);
-        else if (auto msg = dynamic_cast<const BroadcastCTS *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastCTS>(frame))
             handleCTS(msg);
     }
 
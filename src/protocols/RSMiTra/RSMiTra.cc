@@ -208,11 +208,12 @@ namespace rlora
     void RSMiTra::handlePacket(Packet *packet)
     {
         auto chunk = packet->peekAtFront<inet::Chunk>();
+        auto frame = asLoRaFrame(chunk.get());
         Ptr<const MessageInfoTag> infoTag = packet->getTag<MessageInfoTag>();
 
         logEffectiveReception(packet);
 
-        if (auto msg = dynamic_cast<const BroadcastRts *>(chunk.get()))
+        if (auto msg = loRaFrameCast<BroadcastRts>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -242,7 +243,7 @@ namespace rlora
             sourceOfRTS_CTSData = msg->getHop();
             setRTSsource(msg->getHop());
         }
-        else if (auto msg = dynamic_cast<const BroadcastContinuousRts *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastContinuousRts>(frame))
         {
             int messageId = msg->getMessageId();
             int source = msg->getSource();
@@ -256,9 +257,9 @@ namespace rlora
                 setRTSsource(msg->getHopId());
             }
         }
-        else if (auto msg = dynamic_cast<const BroadcastFragment *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastFragment>(frame))
             handleFragment(msg, infoTag);
-        else if (auto msg = dynamic_cast<const BroadcastCTS *>(chunk.get()))
+        else if (auto msg = loRaFrameCast<BroadcastCTS>(frame))
             handleCTS(msg);
     }
 